@@ -5,12 +5,19 @@
  * Notes on use:
  * 
  * If you only need to write data to EEPROM for your project and don't need to retrieve it, be sure not to use the
- * EEPROMVersionControl::printVersionData() function. This function relies on Serial.print statements. If you exclude
- * this function and don't use the Serial library anywhere else in your program, you can save about 6% of available RAM. 
+ * EEPROMVersionControl::printVersionData() function with Serial. If you don't use the Serial library anywhere in your
+ * program, you can save about 6% of available RAM. The print functions take any Print object as their last parameter
+ * (Serial is just the default), so you can also send the output to SoftwareSerial, an LCD, etc. instead. 
  * 
  * If you avoid using the setter functions to create the version data you plan to write to EEPROM, you can save a few more
  * bytes of available RAM. I put the setter functions in here for convenience, but it's better to write the data directly
  * in the EEPROM_Version_Control.h file. 
+ * 
+ * If you only write the values from CL_Version_Data.conf, call EEPROMVersionControl::writeDataToEEPROM() with no struct.
+ * The record is then built at compile time and copied from flash, so you don't need a versionData struct in RAM at all.
+ * To do that at every boot, call EEPROMVersionControl::ensureVersionStamped(). It only writes when the stored data differs
+ * from CL_Version_Data.conf. The up-to-date case reads only the record header and the stored fingerprint: 10 EEPROM reads
+ * with a single slot, 8 more per extra slot. Pass true to also check the payload CRC, which reads the whole record.
 */
 
 EEPROMVersionControl::versionData projectVersionData;     // struct for storing the data we plan to write to EEPROM
@@ -21,7 +28,7 @@ void setup() {
   
   // first, examine the default data:
   Serial.println("First, let's see what data will be written to EEPROM: ");
-  EEPROMVersionControl::printVersionData(projectVersionData);
+  EEPROMVersionControl::printVersionData(projectVersionData, Serial);
 
   // If needed, you can use the setter methods to safely change the fields that will be written.
   // If you change it to a value that is too large for the field you're writing to, the compiler
@@ -40,7 +47,8 @@ void setup() {
   // Finally, you can retrieve previously written data from EEPROM:
   Serial.println("\nNow retrieve the data from EEPROM: ");
   EEPROMVersionControl::getVersionData(retrievedData);        // getVersionData returns false if no valid data exists to retrieve
-  EEPROMVersionControl::printVersionData(retrievedData);
+  EEPROMVersionControl::printVersionData(retrievedData, Serial);
+  EEPROMVersionControl::printLibraryVersion(retrievedData, Serial);
 }
 
 
@@ -3,14 +3,13 @@
 
 /**
  * EEPROM data dumper
+ * 
+ * Prints the version data straight from EEPROM, so no versionData struct is kept in RAM.
 */
 
-EEPROMVersionControl::versionData retrievedData;          // struct for retrieving already written data from EEPROM
-
 void setup() {
   Serial.begin(115200);
-  EEPROMVersionControl::getVersionData(retrievedData);        // getVersionData returns false if no valid data exists to retrieve
-  EEPROMVersionControl::printVersionData(retrievedData);
+  EEPROMVersionControl::printVersionDataFromEEPROM(Serial);   // prints "Version data does not exist." if no valid data is stored
 }
 
 void loop() {
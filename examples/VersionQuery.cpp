@@ -0,0 +1,23 @@
+#include <Arduino.h>
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_Serial.h>
+
+/**
+ * Version query
+ * 
+ * Answers the binary version query from an end-of-line tester: the tester sends one request byte and gets the
+ * stored record back in a single CRC-checked frame (see EEPROM_VC_Serial.h). On a PC, read it with
+ * extras/tools/serial_query.cpp:   eeprom_vc_query /dev/ttyUSB0
+*/
+
+void setup() {
+  Serial.begin(115200);
+  EEPROMVersionControl::ensureVersionStamped();
+}
+
+void loop() {
+  EEPROMVersionControl::serviceVersionQuery(Serial);   // answers a query, if one came in
+
+  // ... the rest of the sketch. If it reads Serial itself, pass each byte it reads to
+  // EEPROMVersionControl::handleVersionQuery(byte, Serial) instead.
+}
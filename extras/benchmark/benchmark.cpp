@@ -0,0 +1,191 @@
+/**
+ * Host benchmark for EEPROM_Version_Control.h.
+ *
+ * Runs the library's read, write, validate and print paths against SimulatedEEPROM and prints one JSON
+ * object per line (JSON Lines), so results can be diffed or loaded into a spreadsheet to track regressions.
+ *
+ * Every case line has these fields:
+ *   variant               storage configuration the binary was built with (see CMakeLists.txt)
+ *   case                  which path was measured
+ *   eeprom_bytes_written  cells erased+written by one call
+ *   eeprom_bytes_read     cells read by one call
+ *   simulated_us          simulated EEPROM time of one call (WRITE_TIME_US per byte written)
+ *   host_ns               mean host CPU time of one call (CLOCK_PROCESS_CPUTIME_ID, less the cost of reading it)
+ *   max_cell_wear         highest number of writes any single cell received during the case
+ *   ram_bytes             RAM the caller needs for the call (the versionData struct or output buffer)
+ *
+ * A final "data_footprint" line lists the size of the record, the EEPROM region and the data kept in flash. Code
+ * size isn't measured here, since host code says nothing about AVR code; run avr-size on the firmware's ELF for that.
+ */
+
+#include <EEPROM_Version_Control.h>
+#include <time.h>
+#include <vector>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    const int ITERATIONS = 2000;        // timed repetitions per case, each on a freshly prepared EEPROM
+    const int ENDURANCE_UPDATES = 1000; // field updates in the wear case
+
+    /**
+     * @brief Print sink that throws everything away, so print cases measure the library, not stdout.
+     */
+    struct NullPrint : public Print {
+        size_t write(uint8_t) override { return 1; }
+        using Print::write;
+    };
+
+    NullPrint nullOut;
+    versionData configured;
+    versionData changed;
+    versionData retrieved;
+
+    void report(const char *name, uint32_t written, uint32_t read, uint64_t simulatedMicros,
+                double hostNanos, uint32_t maxWear, size_t ramBytes) {
+        printf("{\"variant\":\"%s\",\"case\":\"%s\",\"eeprom_bytes_written\":%u,\"eeprom_bytes_read\":%u,"
+               "\"simulated_us\":%llu,\"host_ns\":%.1f,\"max_cell_wear\":%u,\"ram_bytes\":%zu}\n",
+               EEPROM_VC_BENCHMARK_VARIANT, name, written, read, static_cast<unsigned long long>(simulatedMicros),
+               hostNanos, maxWear, ramBytes);
+    }
+
+    /**
+     * @brief CPU time used by this process so far. Unlike a wall clock, it doesn't count time the host spent on
+     * other processes.
+     */
+    uint64_t cpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+    }
+
+    /**
+     * @brief mean cost of the two cpuNanos() calls around a measured call, subtracted from every measurement.
+     */
+    double clockOverheadNanos() {
+        static double overhead = -1;
+        if (overhead < 0) {
+            uint64_t total = 0;
+            for (int i = 0; i < ITERATIONS; i++) {
+                const uint64_t start = cpuNanos();
+                total += cpuNanos() - start;
+            }
+            overhead = static_cast<double>(total) / ITERATIONS;
+        }
+        return overhead;
+    }
+
+    uint32_t maxWearSince(const SimulatedEEPROM &device, const std::vector<uint32_t> &before) {
+        uint32_t worst = 0;
+        for (size_t i = 0; i < device.size(); i++) {
+            uint32_t delta = device.wear(i) - before[i];
+            if (delta > worst) worst = delta;
+        }
+        return worst;
+    }
+
+    /**
+     * @brief measures `op` once for its EEPROM cost and ITERATIONS times for host CPU time.
+     * `setup` puts a freshly erased EEPROM into the state the case starts from and is not measured.
+     */
+    template <typename Setup, typename Op>
+    void runCase(const char *name, size_t ramBytes, Setup setup, Op op) {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+
+        setup();
+        std::vector<uint32_t> wearBefore(device.size());
+        for (size_t i = 0; i < device.size(); i++) wearBefore[i] = device.wear(i);
+        device.resetStats();
+        op();
+        uint32_t written = device.bytesWritten();
+        uint32_t read = device.bytesRead();
+        uint64_t simulatedMicros = device.elapsedMicros();
+        uint32_t maxWear = maxWearSince(device, wearBefore);
+
+        uint64_t total = 0;
+        for (int i = 0; i < ITERATIONS; i++) {
+            device.erase();
+            setup();
+            const uint64_t start = cpuNanos();
+            op();
+            total += cpuNanos() - start;
+        }
+        double hostNanos = static_cast<double>(total) / ITERATIONS - clockOverheadNanos();
+        if (hostNanos < 0) hostNanos = 0;
+
+        report(name, written, read, simulatedMicros, hostNanos, maxWear, ramBytes);
+    }
+
+    void nothing() {}
+    void writeConfigured() { writeDataToEEPROM(configured, true); }
+
+    /**
+     * @brief rewrites the record ENDURANCE_UPDATES times, alternating between two software versions,
+     * and reports the totals. This is where wear leveling shows up in max_cell_wear.
+     */
+    void runEnduranceCase() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeConfigured();
+        device.resetStats();
+        std::vector<uint32_t> wearBefore(device.size());
+        for (size_t i = 0; i < device.size(); i++) wearBefore[i] = device.wear(i);
+
+        const uint64_t start = cpuNanos();
+        for (int i = 0; i < ENDURANCE_UPDATES; i++) {
+            writeDataToEEPROM((i % 2) ? configured : changed, true);
+        }
+        double hostNanos = static_cast<double>(cpuNanos() - start);
+
+        report("write_1000_field_updates", device.bytesWritten(), device.bytesRead(), device.elapsedMicros(),
+               hostNanos, maxWearSince(device, wearBefore), sizeof(versionData));
+    }
+
+    void reportFootprint() {
+        const char *const labels[] = {PrintStrings::PRINT_PROJECT_NAME, PrintStrings::PRINT_VENDOR_NAME,
+                                      PrintStrings::PRINT_PROJECT_NAME_VERSION, PrintStrings::PRINT_SOFTWARE_VERSION,
+                                      PrintStrings::PRINT_SOFTWARE_DATE, PrintStrings::PRINT_DATA_DNE,
+                                      PrintStrings::PRINT_LIBRARY_VERSION};
+        size_t labelBytes = 0;
+        for (const char *label : labels) labelBytes += strlen(label) + 1;
+        printf("{\"variant\":\"%s\",\"case\":\"data_footprint\",\"record_bytes\":%u,\"slot_count\":%u,\"slot_bytes\":%u,"
+               "\"eeprom_region_bytes\":%u,\"ram_versionData_bytes\":%u,\"flash_record_image_bytes\":%zu,"
+               "\"flash_crc_table_bytes\":%zu,\"flash_label_bytes\":%zu}\n",
+               EEPROM_VC_BENCHMARK_VARIANT, RECORD_BYTES, SLOT_COUNT, SLOT_BYTES, VERSION_DATA_REGION_BYTES,
+               static_cast<unsigned>(RECORD_BYTES), sizeof(ConfiguredRecord::bytes), sizeof(CRC16NibbleTable::entries), labelBytes);
+    }
+}
+
+int main() {
+    setSoftwareVersion(changed, "1.0.0.1");
+
+    runCase("write_fresh", sizeof(versionData), nothing, writeConfigured);
+    runCase("write_identical", sizeof(versionData), writeConfigured, writeConfigured);
+    runCase("write_one_field_changed", sizeof(versionData), writeConfigured, [] { writeDataToEEPROM(changed, true); });
+    runCase("write_from_flash_fresh", 0, nothing, [] { writeDataToEEPROM(true); });
+    runCase("write_from_flash_identical", 0, writeConfigured, [] { writeDataToEEPROM(true); });
+    runCase("getVersionData", sizeof(versionData), writeConfigured, [] { getVersionData(retrieved); });
+    runCase("getVersionData_empty", sizeof(versionData), nothing, [] { getVersionData(retrieved); });
+    runCase("dataIsWritten", 0, writeConfigured, [] { (void)dataIsWritten(); });
+    runCase("validateVersionData", 0, writeConfigured, [] { (void)validateVersionData(); });
+    runCase("readSoftwareVersion", sizeof(versionData::softwareVersion), writeConfigured, [] {
+        char buffer[sizeof(versionData::softwareVersion)];
+        readSoftwareVersion(buffer, sizeof(buffer));
+    });
+    runCase("printVersionData", sizeof(versionData), writeConfigured, [] {
+        getVersionData(retrieved);
+        printVersionData(retrieved, nullOut);
+    });
+    runCase("printVersionDataFromEEPROM", 0, writeConfigured, [] { printVersionDataFromEEPROM(nullOut); });
+    runCase("boot_check_manual", sizeof(versionData), writeConfigured, [] {
+        if (!dataIsWritten() || !getVersionData(retrieved) || strcmp(retrieved.softwareVersion, SOFTWARE_VERSION) != 0) {
+            writeDataToEEPROM(true);
+        }
+    });
+    runCase("ensureVersionStamped", 0, writeConfigured, [] { ensureVersionStamped(); });
+    runEnduranceCase();
+    reportFootprint();
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * eeprom_vc_image: builds and inspects EEPROM images holding the version data, on the host.
+ *
+ *     eeprom_vc_image encode [field options] [--raw] <output>
+ *     eeprom_vc_image decode <dump>
+ *
+ * encode writes the record the way the firmware would (writeDataToEEPROM() on a SimulatedEEPROM), so the image
+ * can be flashed together with the program, e.g. `avrdude ... -U flash:w:fw.hex:i -U eeprom:w:version.eep:i`.
+ * The values come from CL_Version_Data.conf unless overridden with --name, --vendor, --project-version,
+ * --software-version or --date; values too long for their field are an error, not truncated. The output is an
+ * Intel HEX file covering the version data region (VERSION_DATA_START_ADDRESS to VERSION_DATA_END_ADDRESS), or
+ * with --raw a binary image of the whole EEPROM with the rest erased.
+ *
+ * decode reads an Intel HEX file or a raw dump (`avrdude -U eeprom:r:dump.bin:r`), prints the state of every slot
+ * and the newest valid record, with the library version that wrote it. Records of older library versions are read
+ * with the decoders of EEPROM_VC_Migration.h, like getMigratedVersionData() on the device. Exit status: 0 if a
+ * valid record was found, 1 if not, 2 for usage or file errors.
+ *
+ * The record layout, placement and geometry are those of the library build the tool is compiled with, so build it
+ * with the same CL_Version_Data.conf and EEPROM_VC_GEOMETRY as the firmware (see extras/tools/CMakeLists.txt).
+ */
+
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_Migration.h>
+#include "record_image.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    const int EXIT_NO_RECORD = 1;
+    const int EXIT_USAGE = 2;
+
+    int usage() {
+        fprintf(stderr,
+                "usage: eeprom_vc_image encode [--name <text>] [--vendor <text>] [--project-version <n>]\n"
+                "                              [--software-version <text>] [--date <text>] [--raw] <output>\n"
+                "       eeprom_vc_image decode <dump.eep|dump.bin>\n");
+        return EXIT_USAGE;
+    }
+
+    /**
+     * @brief copies `value` into a string field, or says why it doesn't fit.
+     */
+    bool setField(char *field, size_t fieldSize, const char *option, const char *value) {
+        if (strlen(value) >= fieldSize) {
+            fprintf(stderr, "%s: \"%s\" is longer than %zu characters\n", option, value, fieldSize - 1);
+            return false;
+        }
+        safeStrCopy(field, value, fieldSize);
+        return true;
+    }
+
+    bool writeOutput(const char *path, const std::string &contents) {
+        FILE *file = fopen(path, "wb");
+        if (!file) return false;
+        bool ok = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        return (fclose(file) == 0) && ok;
+    }
+
+    int encode(int argc, char **argv) {
+        versionData data;
+        bool raw = false;
+        const char *output = nullptr;
+        for (int i = 0; i < argc; i++) {
+            const char *option = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(option, "--raw") == 0) {
+                raw = true;
+            } else if (strcmp(option, "--name") == 0 && hasValue) {
+                if (!setField(data.projectName, sizeof(data.projectName), option, argv[++i])) return EXIT_USAGE;
+            } else if (strcmp(option, "--vendor") == 0 && hasValue) {
+                if (!setField(data.vendor, sizeof(data.vendor), option, argv[++i])) return EXIT_USAGE;
+            } else if (strcmp(option, "--software-version") == 0 && hasValue) {
+                if (!setField(data.softwareVersion, sizeof(data.softwareVersion), option, argv[++i])) return EXIT_USAGE;
+            } else if (strcmp(option, "--date") == 0 && hasValue) {
+                if (!setField(data.finalSoftwareDate, sizeof(data.finalSoftwareDate), option, argv[++i])) return EXIT_USAGE;
+            } else if (strcmp(option, "--project-version") == 0 && hasValue) {
+                char *end;
+                unsigned long version = strtoul(argv[++i], &end, 10);
+                if (*end != '\0' || version > 0xFF) {
+                    fprintf(stderr, "%s: \"%s\" is not a number from 0 to 255\n", option, argv[i]);
+                    return EXIT_USAGE;
+                }
+                setProjectVersion(data, static_cast<uint8_t>(version));
+            } else if (option[0] != '-' && !output) {
+                output = option;
+            } else {
+                return usage();
+            }
+        }
+        if (!output) return usage();
+
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeDataToEEPROM(data, true);
+
+        std::string contents;
+        if (raw) {
+            contents.assign(reinterpret_cast<const char *>(device.data()), device.size());
+        } else {
+            writeIntelHex(contents, VERSION_DATA_START_ADDRESS, device.data() + VERSION_DATA_START_ADDRESS,
+                          VERSION_DATA_END_ADDRESS - VERSION_DATA_START_ADDRESS);
+        }
+        if (!writeOutput(output, contents)) {
+            fprintf(stderr, "can't write %s\n", output);
+            return EXIT_USAGE;
+        }
+        return 0;
+    }
+
+    int decode(int argc, char **argv) {
+        if (argc != 1) return usage();
+        std::vector<char> contents;
+        if (!readFile(argv[0], contents)) {
+            fprintf(stderr, "can't read %s\n", argv[0]);
+            return EXIT_USAGE;
+        }
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        std::string error;
+        if (!loadDump(contents.data(), contents.size(), device, error)) {
+            fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+            return EXIT_USAGE;
+        }
+
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            printf("slot %u at 0x%04X: %s\n", slot, recordAddress(slot), recordStatusName(checkSlot(slot)));
+        }
+        versionData data;
+        const uint8_t fromVersion = getMigratedVersionData(data);
+        if (fromVersion == 0) {
+            printf("no valid version data\n");
+            return EXIT_NO_RECORD;
+        }
+        if (fromVersion == LIBRARY_VERSION) {
+            uint16_t sequence = 0;
+            const uint8_t newest = findNewestSlot(sequence);
+            printf("newest record:    slot %u", newest);
+            if (SLOT_COUNT > 1) printf(", sequence %u", sequence);
+            printf("\n");
+        } else {
+            printf("newest record:    library version %u layout, not yet migrated\n", fromVersion);
+        }
+        printf("library version:  %u\n", fromVersion);
+        printf("project name:     %s\n", data.projectName);
+        printf("vendor:           %s\n", data.vendor);
+        printf("project version:  %u\n", data.projectVersion);
+        printf("software version: %s\n", data.softwareVersion);
+        printf("software date:    %s\n", data.finalSoftwareDate);
+        printf("fingerprint:      0x%08lX%s\n", static_cast<unsigned long>(storedFingerprint(data)),
+               (fromVersion == LIBRARY_VERSION) ? "" : " (computed, not stored by that version)");
+        return 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "encode") == 0) return encode(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "decode") == 0) return decode(argc - 2, argv + 2);
+    return usage();
+}
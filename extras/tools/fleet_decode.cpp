@@ -0,0 +1,256 @@
+/**
+ * eeprom_vc_fleet: decodes a directory of EEPROM dumps (returned units, audits) and counts what is on them.
+ *
+ *     eeprom_vc_fleet [--jobs <n>] [--json] [--units <file.csv>] <directory>
+ *
+ * Every regular file in the directory is memory mapped and loaded like eeprom_vc_image decode does (Intel HEX or
+ * a raw dump of the whole EEPROM). The record is read with getMigratedVersionData() (EEPROM_VC_Migration.h), so a
+ * unit still holding a record of an older library version is decoded too; the current layout is checked with the
+ * library's own validation (magic number, library version, length, CRC). Files are spread over --jobs worker
+ * threads (one per core by default); each thread has its own SimulatedEEPROM, see SimulatedEEPROM::attach().
+ *
+ * The output on stdout is the number of units per project name, vendor, project version and software version,
+ * as CSV, or with --json a JSON object that also counts the valid units by the library version that wrote their
+ * record, and the files by status:
+ *
+ *     valid           a valid record was found
+ *     empty           no record in any slot
+ *     uncommitted     no valid record, and a slot was left half written
+ *     other library version, bad length, bad CRC
+ *                     no valid record, and a slot has a header but fails that check
+ *     unreadable      not Intel HEX, and not the size of the EEPROM
+ *
+ * --units writes one CSV line per file (sorted by file name) with its status, the library version and slot of its
+ * record (no slot for an older layout), the decoded fields, and why an unreadable file couldn't be loaded.
+ * Exit status: 0 on success, 2 for usage errors or if the directory can't be read.
+ */
+
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_Migration.h>
+#include "record_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    const int EXIT_USAGE = 2;
+    const char *const UNREADABLE = "unreadable";
+
+    struct unitResult {
+        std::string file;
+        const char *status = UNREADABLE;
+        std::string error;
+        uint8_t libraryVersion = 0;     // that wrote the record, 0 if there is none
+        uint8_t slot = NO_SLOT;         // of a record in the current layout
+        versionData data;
+    };
+
+    // units are grouped by project name, vendor, project version and software version
+    typedef std::tuple<std::string, std::string, unsigned, std::string> versionKey;
+
+    int usage() {
+        fprintf(stderr, "usage: eeprom_vc_fleet [--jobs <n>] [--json] [--units <file.csv>] <directory>\n");
+        return EXIT_USAGE;
+    }
+
+    /**
+     * @brief checks the image attached to this thread, in any layout getMigratedVersionData() reads. Without a
+     * valid record, the first slot that isn't empty says why.
+     */
+    void decodeImage(unitResult &unit) {
+        unit.libraryVersion = getMigratedVersionData(unit.data);
+        if (unit.libraryVersion != 0) {
+            if (unit.libraryVersion == LIBRARY_VERSION) unit.slot = findNewestSlot();
+            unit.status = recordStatusName(RECORD_VALID);
+            return;
+        }
+        unit.status = recordStatusName(RECORD_EMPTY);
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            recordStatus status = checkSlot(slot);
+            if (status != RECORD_EMPTY) {
+                unit.status = recordStatusName(status);
+                return;
+            }
+        }
+    }
+
+    void decodeFile(const std::string &directory, unitResult &unit, SimulatedEEPROM &device) {
+        const std::string path = directory + "/" + unit.file;
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            unit.error = strerror(errno);
+            if (fd >= 0) close(fd);
+            return;
+        }
+        if (info.st_size == 0) {
+            unit.error = "empty file";
+            close(fd);
+            return;
+        }
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            unit.error = strerror(errno);
+            return;
+        }
+        if (loadDump(static_cast<const char *>(mapped), info.st_size, device, unit.error)) {
+            decodeImage(unit);
+        }
+        munmap(mapped, info.st_size);
+    }
+
+    bool listFiles(const std::string &directory, std::vector<unitResult> &units) {
+        DIR *dir = opendir(directory.c_str());
+        if (!dir) return false;
+        while (dirent *entry = readdir(dir)) {
+            struct stat info;
+            const std::string path = directory + "/" + entry->d_name;
+            if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                units.emplace_back();
+                units.back().file = entry->d_name;
+            }
+        }
+        closedir(dir);
+        std::sort(units.begin(), units.end(), [](const unitResult &a, const unitResult &b) { return a.file < b.file; });
+        return true;
+    }
+
+    void decodeAll(const std::string &directory, std::vector<unitResult> &units, unsigned jobs) {
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            SimulatedEEPROM device;
+            SimulatedEEPROM::attach(device);
+            for (size_t i = next++; i < units.size(); i = next++) {
+                decodeFile(directory, units[i], device);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < jobs; i++) threads.emplace_back(worker);
+        worker();
+        for (std::thread &thread : threads) thread.join();
+    }
+
+    std::string csvQuoted(const std::string &value) {
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    bool writeUnits(const char *path, const std::vector<unitResult> &units) {
+        FILE *file = fopen(path, "w");
+        if (!file) return false;
+        fprintf(file, "file,status,library_version,slot,project_name,vendor,project_version,software_version,software_date,"
+                      "fingerprint,error\n");
+        for (const unitResult &unit : units) {
+            fprintf(file, "%s,%s,", csvQuoted(unit.file).c_str(), unit.status);
+            if (unit.libraryVersion == 0) {
+                fprintf(file, ",,,,,,,,%s\n", csvQuoted(unit.error).c_str());
+                continue;
+            }
+            fprintf(file, "%u,", unit.libraryVersion);
+            if (unit.slot != NO_SLOT) fprintf(file, "%u", unit.slot);
+            fprintf(file, ",%s,%s,%u,%s,%s,0x%08lX,\n", csvQuoted(fieldString(unit.data.projectName)).c_str(),
+                    csvQuoted(fieldString(unit.data.vendor)).c_str(), unit.data.projectVersion,
+                    csvQuoted(fieldString(unit.data.softwareVersion)).c_str(),
+                    csvQuoted(fieldString(unit.data.finalSoftwareDate)).c_str(),
+                    static_cast<unsigned long>(storedFingerprint(unit.data)));
+        }
+        return fclose(file) == 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool json = false;
+    const char *unitsPath = nullptr;
+    const char *directory = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+            if (jobs == 0) return usage();
+        } else if (strcmp(argv[i], "--units") == 0 && i + 1 < argc) {
+            unitsPath = argv[++i];
+        } else if (argv[i][0] != '-' && !directory) {
+            directory = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if (!directory) return usage();
+
+    std::vector<unitResult> units;
+    if (!listFiles(directory, units)) {
+        fprintf(stderr, "can't read directory %s: %s\n", directory, strerror(errno));
+        return EXIT_USAGE;
+    }
+    decodeAll(directory, units, jobs);
+
+    std::map<std::string, size_t> statusCounts;
+    std::map<versionKey, size_t> versionCounts;
+    std::map<unsigned, size_t> libraryVersionCounts;
+    for (const unitResult &unit : units) {
+        statusCounts[unit.status]++;
+        if (unit.libraryVersion != 0) {
+            libraryVersionCounts[unit.libraryVersion]++;
+            versionCounts[versionKey(fieldString(unit.data.projectName), fieldString(unit.data.vendor), unit.data.projectVersion,
+                                     fieldString(unit.data.softwareVersion))]++;
+        }
+    }
+
+    if (unitsPath && !writeUnits(unitsPath, units)) {
+        fprintf(stderr, "can't write %s\n", unitsPath);
+        return EXIT_USAGE;
+    }
+
+    if (json) {
+        printf("{\"files\":%zu,\"status\":{", units.size());
+        const char *separator = "";
+        for (const auto &count : statusCounts) {
+            printf("%s%s:%zu", separator, jsonQuoted(count.first).c_str(), count.second);
+            separator = ",";
+        }
+        printf("},\"library_versions\":{");
+        separator = "";
+        for (const auto &count : libraryVersionCounts) {
+            printf("%s\"%u\":%zu", separator, count.first, count.second);
+            separator = ",";
+        }
+        printf("},\"versions\":[");
+        separator = "";
+        for (const auto &count : versionCounts) {
+            printf("%s{\"project_name\":%s,\"vendor\":%s,\"project_version\":%u,\"software_version\":%s,\"units\":%zu}",
+                   separator, jsonQuoted(std::get<0>(count.first)).c_str(), jsonQuoted(std::get<1>(count.first)).c_str(),
+                   std::get<2>(count.first), jsonQuoted(std::get<3>(count.first)).c_str(), count.second);
+            separator = ",";
+        }
+        printf("]}\n");
+    } else {
+        printf("project_name,vendor,project_version,software_version,units\n");
+        for (const auto &count : versionCounts) {
+            printf("%s,%s,%u,%s,%zu\n", csvQuoted(std::get<0>(count.first)).c_str(), csvQuoted(std::get<1>(count.first)).c_str(),
+                   std::get<2>(count.first), csvQuoted(std::get<3>(count.first)).c_str(), count.second);
+        }
+    }
+    return 0;
+}
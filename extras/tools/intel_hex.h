@@ -0,0 +1,132 @@
+/**
+ * Intel HEX reading and writing for the host tools, in the format avr-objcopy writes .eep files in and avrdude
+ * reads them (`-U eeprom:w:file.eep:i`): data records of up to 16 bytes and an end of file record. Only the
+ * first 64 KB are addressable, which covers every EEPROM the library supports.
+ */
+
+#ifndef EEPROM_VC_INTEL_HEX_H
+#define EEPROM_VC_INTEL_HEX_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+namespace EEPROMVersionControl {
+
+    constexpr uint8_t INTEL_HEX_DATA = 0x00;
+    constexpr uint8_t INTEL_HEX_END_OF_FILE = 0x01;
+    constexpr uint8_t INTEL_HEX_EXTENDED_SEGMENT = 0x02;
+    constexpr uint8_t INTEL_HEX_EXTENDED_LINEAR = 0x04;
+    constexpr uint8_t INTEL_HEX_LINE_BYTES = 16;
+
+    /**
+     * @brief true if `text` looks like Intel HEX (its first non-blank character is a ':'), as opposed to a raw dump.
+     */
+    inline bool isIntelHex(const char *text, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            if (text[i] == ':') return true;
+            if (text[i] != ' ' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') return false;
+        }
+        return false;
+    }
+
+    /**
+     * @brief appends the Intel HEX of `length` bytes that go to `address` to `out`, followed by the end of file record.
+     */
+    inline void writeIntelHex(std::string &out, uint16_t address, const uint8_t *bytes, size_t length) {
+        char field[16];
+        auto record = [&](uint8_t type, uint16_t at, const uint8_t *data, uint8_t count) {
+            uint8_t sum = count + (at >> 8) + (at & 0xFF) + type;
+            snprintf(field, sizeof(field), ":%02X%04X%02X", count, at, type);
+            out += field;
+            for (uint8_t i = 0; i < count; i++) {
+                snprintf(field, sizeof(field), "%02X", data[i]);
+                out += field;
+                sum += data[i];
+            }
+            snprintf(field, sizeof(field), "%02X\n", static_cast<uint8_t>(-sum));
+            out += field;
+        };
+        for (size_t offset = 0; offset < length; offset += INTEL_HEX_LINE_BYTES) {
+            size_t count = (length - offset < INTEL_HEX_LINE_BYTES) ? length - offset : INTEL_HEX_LINE_BYTES;
+            record(INTEL_HEX_DATA, static_cast<uint16_t>(address + offset), bytes + offset, static_cast<uint8_t>(count));
+        }
+        record(INTEL_HEX_END_OF_FILE, 0, nullptr, 0);
+    }
+
+    inline int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    /**
+     * @brief copies the data records of the Intel HEX in `text` into `image`. Bytes the file doesn't cover are left
+     * as they are, so callers fill `image` with 0xFF (erased EEPROM) first.
+     *
+     * @param error set to a description, with the line number, if the file is malformed.
+     * @return false if the file is malformed, has a bad checksum, or has data beyond `imageSize`.
+     */
+    inline bool readIntelHex(const char *text, size_t length, uint8_t *image, size_t imageSize, std::string &error) {
+        uint32_t base = 0;
+        unsigned line = 0;
+        size_t i = 0;
+        auto fail = [&](const char *what) {
+            char message[80];
+            snprintf(message, sizeof(message), "line %u: %s", line, what);
+            error = message;
+            return false;
+        };
+        while (i < length) {
+            line++;
+            while (i < length && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r')) i++;
+            if (i < length && text[i] == '\n') {
+                i++;
+                continue;
+            }
+            if (i >= length) break;
+            if (text[i++] != ':') return fail("expected ':'");
+
+            uint8_t bytes[5 + 255];
+            size_t count = 0;
+            while (i + 1 < length && hexDigit(text[i]) >= 0 && hexDigit(text[i + 1]) >= 0 && count < sizeof(bytes)) {
+                bytes[count++] = static_cast<uint8_t>(hexDigit(text[i]) << 4 | hexDigit(text[i + 1]));
+                i += 2;
+            }
+            while (i < length && text[i] != '\n') {
+                if (text[i] != '\r' && text[i] != ' ' && text[i] != '\t') return fail("not a hex digit");
+                i++;
+            }
+            if (count < 5 || count != 5u + bytes[0]) return fail("record length doesn't match its byte count");
+            uint8_t sum = 0;
+            for (size_t j = 0; j < count; j++) sum += bytes[j];
+            if (sum != 0) return fail("bad checksum");
+
+            const uint8_t dataLength = bytes[0];
+            const uint16_t address = static_cast<uint16_t>(bytes[1] << 8 | bytes[2]);
+            const uint8_t *data = bytes + 4;
+            switch (bytes[3]) {
+                case INTEL_HEX_DATA:
+                    if (base + address + dataLength > imageSize) return fail("data beyond the end of the EEPROM");
+                    for (uint8_t j = 0; j < dataLength; j++) image[base + address + j] = data[j];
+                    break;
+                case INTEL_HEX_END_OF_FILE:
+                    return true;
+                case INTEL_HEX_EXTENDED_SEGMENT:
+                    if (dataLength != 2) return fail("bad extended segment address record");
+                    base = static_cast<uint32_t>(data[0] << 8 | data[1]) << 4;
+                    break;
+                case INTEL_HEX_EXTENDED_LINEAR:
+                    if (dataLength != 2) return fail("bad extended linear address record");
+                    base = static_cast<uint32_t>(data[0] << 8 | data[1]) << 16;
+                    break;
+                default:
+                    break;          // start address records don't matter for EEPROM
+            }
+        }
+        return fail("no end of file record");
+    }
+}
+
+#endif // EEPROM_VC_INTEL_HEX_H
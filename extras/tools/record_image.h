@@ -0,0 +1,127 @@
+/**
+ * Shared by the host tools: loading EEPROM dumps into a SimulatedEEPROM, checking the version data slots in them
+ * with the library's own layout (recordAddress(), recordHeader, crc16OfStorage()), so the tools always agree
+ * with the firmware they were built with about where the record is and what makes it valid. Also formatting
+ * record fields for the tools' output.
+ */
+
+#ifndef EEPROM_VC_RECORD_IMAGE_H
+#define EEPROM_VC_RECORD_IMAGE_H
+
+#include <EEPROM_Version_Control.h>
+#include "intel_hex.h"
+
+#include <string>
+#include <vector>
+
+namespace EEPROMVersionControl {
+
+    /**
+     * @brief what is in a slot, from the checks slotIsValid() makes, in the same order.
+     */
+    enum recordStatus : uint8_t {
+        RECORD_VALID,
+        RECORD_EMPTY,                   // erased, or no versionData magic number
+        RECORD_UNCOMMITTED,             // commit byte cleared: the write was interrupted
+        RECORD_OTHER_LIBRARY_VERSION,
+        RECORD_BAD_LENGTH,
+        RECORD_BAD_CRC,
+    };
+
+    inline const char *recordStatusName(recordStatus status) {
+        switch (status) {
+            case RECORD_VALID: return "valid";
+            case RECORD_EMPTY: return "empty";
+            case RECORD_UNCOMMITTED: return "uncommitted";
+            case RECORD_OTHER_LIBRARY_VERSION: return "other library version";
+            case RECORD_BAD_LENGTH: return "bad length";
+            default: return "bad CRC";
+        }
+    }
+
+    /**
+     * @brief checks one slot of the active image, telling apart the ways a record can be invalid.
+     */
+    inline recordStatus checkSlot(uint8_t slot) {
+        recordHeader header;
+        readBlock(recordAddress(slot), &header, sizeof(header));
+        if (header.dataWritten == UNCOMMITTED_MARKER && header.recordLength == RECORD_PAYLOAD_BYTES) {
+            return RECORD_UNCOMMITTED;
+        }
+        if (header.dataWritten != DATA_EXISTS_MAGIC_NUMBER) return RECORD_EMPTY;
+        if (header.libraryVersion != LIBRARY_VERSION) return RECORD_OTHER_LIBRARY_VERSION;
+        if (header.recordLength != RECORD_PAYLOAD_BYTES) return RECORD_BAD_LENGTH;
+        if (crc16OfStorage(recordAddress(slot) + RECORD_HEADER_BYTES, header.recordLength) != header.crc) {
+            return RECORD_BAD_CRC;
+        }
+        return RECORD_VALID;
+    }
+
+    /**
+     * @brief a string field of a record as a std::string, stopping at the field size even without a terminator.
+     */
+    template <size_t N>
+    std::string fieldString(const char (&value)[N]) {
+        return std::string(value, strnlen(value, N));
+    }
+
+    /**
+     * @brief `value` as a JSON string.
+     */
+    inline std::string jsonQuoted(const std::string &value) {
+        std::string quoted = "\"";
+        for (unsigned char c : value) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (c < 0x20) {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                quoted += escape;
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * @brief loads a dump, Intel HEX (.eep) or raw, from memory into `device`. Bytes a HEX file doesn't cover read
+     * as erased.
+     *
+     * @param error set to the reason if the dump can't be loaded.
+     */
+    inline bool loadDump(const char *bytes, size_t length, SimulatedEEPROM &device, std::string &error) {
+        if (!isIntelHex(bytes, length)) {
+            if (length != device.size()) {
+                error = "raw dump is " + std::to_string(length) + " bytes, expected " + std::to_string(device.size());
+                return false;
+            }
+            device.loadImage(reinterpret_cast<const uint8_t *>(bytes), length);
+            return true;
+        }
+        std::vector<uint8_t> image(device.size(), 0xFF);
+        if (!readIntelHex(bytes, length, image.data(), image.size(), error)) return false;
+        device.loadImage(image.data(), image.size());
+        return true;
+    }
+
+    /**
+     * @brief reads a whole file into `contents`.
+     */
+    inline bool readFile(const char *path, std::vector<char> &contents) {
+        FILE *file = fopen(path, "rb");
+        if (!file) return false;
+        char buffer[4096];
+        size_t n;
+        contents.clear();
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            contents.insert(contents.end(), buffer, buffer + n);
+        }
+        bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+}
+
+#endif // EEPROM_VC_RECORD_IMAGE_H
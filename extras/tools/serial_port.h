@@ -0,0 +1,172 @@
+/**
+ * POSIX serial port helpers for the host tools that talk the binary version query (EEPROM_VC_Serial.h): opening
+ * a port raw at a given baud rate, a pseudo terminal standing in for a unit, and the tester side of a query.
+ */
+
+#ifndef EEPROM_VC_SERIAL_PORT_H
+#define EEPROM_VC_SERIAL_PORT_H
+
+#include <EEPROM_VC_Serial.h>
+
+#include <string>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace EEPROMVersionControl {
+
+    /**
+     * @brief Print sink writing to a file descriptor, so the firmware's reply code can answer on a pseudo terminal.
+     */
+    class FileDescriptorPrint : public Print {
+    public:
+        explicit FileDescriptorPrint(int fd) : fd(fd) {}
+        size_t write(uint8_t c) override { return ::write(fd, &c, 1) == 1 ? 1 : 0; }
+        using Print::write;
+
+    private:
+        int fd;
+    };
+
+    inline bool baudRate(unsigned long baud, speed_t &speed) {
+        switch (baud) {
+            case 9600: speed = B9600; return true;
+            case 19200: speed = B19200; return true;
+            case 38400: speed = B38400; return true;
+            case 57600: speed = B57600; return true;
+            case 115200: speed = B115200; return true;
+            case 230400: speed = B230400; return true;
+            default: return false;
+        }
+    }
+
+    /**
+     * @brief puts a terminal in raw 8N1 mode, so no byte is translated or held back.
+     */
+    inline bool makeRaw(int fd, speed_t speed, std::string &error) {
+        struct termios settings;
+        if (tcgetattr(fd, &settings) != 0) {
+            error = strerror(errno);
+            return false;
+        }
+        cfmakeraw(&settings);
+        settings.c_cflag |= CLOCAL | CREAD;
+        settings.c_cflag &= ~(CSTOPB | PARENB);
+        settings.c_cc[VMIN] = 0;
+        settings.c_cc[VTIME] = 0;
+        cfsetispeed(&settings, speed);
+        cfsetospeed(&settings, speed);
+        if (tcsetattr(fd, TCSANOW, &settings) != 0) {
+            error = strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief opens a serial port (e.g. /dev/ttyUSB0) raw, 8N1, at `baud`.
+     * @return the file descriptor, or -1 with `error` set.
+     */
+    inline int openSerialPort(const char *path, unsigned long baud, std::string &error) {
+        speed_t speed;
+        if (!baudRate(baud, speed)) {
+            error = "unsupported baud rate " + std::to_string(baud);
+            return -1;
+        }
+        int fd = open(path, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            error = std::string(path) + ": " + strerror(errno);
+            return -1;
+        }
+        if (!makeRaw(fd, speed, error)) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /**
+     * @brief opens a pseudo terminal. Testers open `deviceName` like a serial port; the stand-in reads and writes
+     * `controller`.
+     */
+    inline bool openPseudoTerminal(int &controller, std::string &deviceName, std::string &error) {
+        controller = posix_openpt(O_RDWR | O_NOCTTY);
+        if (controller < 0 || grantpt(controller) != 0 || unlockpt(controller) != 0 || !ptsname(controller)) {
+            error = strerror(errno);
+            if (controller >= 0) close(controller);
+            return false;
+        }
+        deviceName = ptsname(controller);
+        return true;
+    }
+
+    inline long millisecondsSince(const struct timespec &start) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+    }
+
+    /**
+     * @brief sends the request on `fd` and waits up to `timeoutMs` for the reply.
+     *
+     * Input already waiting on the port is discarded first, and bytes before the reply frame are skipped.
+     *
+     * @return RECORD_RECEIVED (with `data` filled in), NO_RECORD_RECEIVED, FRAME_ERROR or RECORD_ERROR, or WAITING
+     *         if no complete reply came in time (with `error` set).
+     */
+    inline versionReplyParser::state queryVersion(int fd, unsigned timeoutMs, versionData &data, std::string &error) {
+        tcflush(fd, TCIFLUSH);
+        const uint8_t request = VERSION_QUERY_REQUEST;
+        if (::write(fd, &request, 1) != 1) {
+            error = strerror(errno);
+            return versionReplyParser::WAITING;
+        }
+        versionReplyParser parser;
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long remaining;
+        while ((remaining = timeoutMs - millisecondsSince(start)) > 0) {
+            struct pollfd ready = {fd, POLLIN, 0};
+            if (poll(&ready, 1, static_cast<int>(remaining)) <= 0) continue;
+            uint8_t buffer[64];
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                error = strerror(errno);
+                return versionReplyParser::WAITING;
+            }
+            for (ssize_t i = 0; i < n; i++) {
+                versionReplyParser::state state = parser.feed(buffer[i]);
+                if (state == versionReplyParser::RECORD_RECEIVED) parser.record(data);
+                if (state != versionReplyParser::WAITING && state != versionReplyParser::RECEIVING) return state;
+            }
+        }
+        error = "no reply within " + std::to_string(timeoutMs) + " ms";
+        return versionReplyParser::WAITING;
+    }
+
+    /**
+     * @brief answers queries arriving on `controller` from the EEPROM image attached to this thread, like a unit
+     * running serviceVersionQuery(), until `timeoutMs` passes without input (forever if negative).
+     */
+    inline void serveVersionQueries(int controller, int timeoutMs) {
+        FileDescriptorPrint out(controller);
+        for (;;) {
+            struct pollfd ready = {controller, POLLIN, 0};
+            int events = poll(&ready, 1, timeoutMs);
+            if (events < 0 && errno == EINTR) continue;
+            if (events <= 0) return;
+            uint8_t buffer[64];
+            ssize_t n = read(controller, buffer, sizeof(buffer));
+            if (n <= 0) return;
+            for (ssize_t i = 0; i < n; i++) handleVersionQuery(buffer[i], out);
+        }
+    }
+}
+
+#endif // EEPROM_VC_SERIAL_PORT_H
@@ -0,0 +1,94 @@
+/**
+ * eeprom_vc_query: reads the version data of a unit over a serial port with the binary query (EEPROM_VC_Serial.h).
+ *
+ *     eeprom_vc_query [--baud <rate>] [--timeout <ms>] [--json] <port>
+ *
+ * The unit's sketch has to answer queries, e.g. with serviceVersionQuery(Serial) in loop(). Without hardware,
+ * eeprom_vc_standin serves an EEPROM image on a pseudo terminal instead. Opening the port resets most Arduino
+ * boards, so give the bootloader time with --timeout (default 2000 ms) on the first query.
+ * Exit status: 0 if the unit has valid version data, 1 if it has none, 2 for usage or communication errors.
+ */
+
+#include <EEPROM_VC_Serial.h>
+#include "record_image.h"
+#include "serial_port.h"
+
+#include <stdio.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    const int EXIT_NO_RECORD = 1;
+    const int EXIT_FAILED = 2;
+
+    int usage() {
+        fprintf(stderr, "usage: eeprom_vc_query [--baud <rate>] [--timeout <ms>] [--json] <port>\n");
+        return EXIT_FAILED;
+    }
+}
+
+int main(int argc, char **argv) {
+    unsigned long baud = 115200;
+    unsigned timeoutMs = 2000;
+    bool json = false;
+    const char *port = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            baud = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeoutMs = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (argv[i][0] != '-' && !port) {
+            port = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if (!port) return usage();
+
+    std::string error;
+    int fd = openSerialPort(port, baud, error);
+    if (fd < 0) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILED;
+    }
+    versionData data;
+    versionReplyParser::state state = queryVersion(fd, timeoutMs, data, error);
+    close(fd);
+
+    switch (state) {
+        case versionReplyParser::RECORD_RECEIVED:
+            break;
+        case versionReplyParser::NO_RECORD_RECEIVED:
+            printf(json ? "{\"valid\":false}\n" : "no valid version data\n");
+            return EXIT_NO_RECORD;
+        case versionReplyParser::FRAME_ERROR:
+            fprintf(stderr, "%s: corrupted reply\n", port);
+            return EXIT_FAILED;
+        case versionReplyParser::RECORD_ERROR:
+            fprintf(stderr, "%s: the unit sent an invalid record\n", port);
+            return EXIT_FAILED;
+        default:
+            fprintf(stderr, "%s: %s\n", port, error.c_str());
+            return EXIT_FAILED;
+    }
+
+    if (json) {
+        printf("{\"valid\":true,\"library_version\":%u,\"project_name\":%s,\"vendor\":%s,\"project_version\":%u,"
+               "\"software_version\":%s,\"software_date\":%s,\"fingerprint\":\"0x%08lX\"}\n",
+               getLibraryVersion(data), jsonQuoted(fieldString(data.projectName)).c_str(), jsonQuoted(fieldString(data.vendor)).c_str(),
+               data.projectVersion, jsonQuoted(fieldString(data.softwareVersion)).c_str(),
+               jsonQuoted(fieldString(data.finalSoftwareDate)).c_str(), static_cast<unsigned long>(storedFingerprint(data)));
+    } else {
+        printf("library version:  %u\n", getLibraryVersion(data));
+        printf("project name:     %s\n", data.projectName);
+        printf("vendor:           %s\n", data.vendor);
+        printf("project version:  %u\n", data.projectVersion);
+        printf("software version: %s\n", data.softwareVersion);
+        printf("software date:    %s\n", data.finalSoftwareDate);
+        printf("fingerprint:      0x%08lX\n", static_cast<unsigned long>(storedFingerprint(data)));
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * eeprom_vc_standin: stands in for a unit answering the binary version query (EEPROM_VC_Serial.h), for developing
+ * and testing tester software without hardware.
+ *
+ *     eeprom_vc_standin [<dump.eep|dump.bin>]
+ *
+ * Opens a pseudo terminal, prints its name (e.g. /dev/pts/3) and answers every query on it with the record in the
+ * dump, or with a freshly written CL_Version_Data.conf record if no dump is given, using the same code a sketch
+ * runs. Point the tester, or eeprom_vc_query, at the printed name. Stop it with Ctrl-C.
+ */
+
+#include <EEPROM_VC_Serial.h>
+#include "record_image.h"
+#include "serial_port.h"
+
+#include <stdio.h>
+
+using namespace EEPROMVersionControl;
+
+int main(int argc, char **argv) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: eeprom_vc_standin [<dump.eep|dump.bin>]\n");
+        return 2;
+    }
+    SimulatedEEPROM device;
+    SimulatedEEPROM::attach(device);
+    std::string error;
+    if (argc == 2) {
+        std::vector<char> contents;
+        if (!readFile(argv[1], contents)) {
+            fprintf(stderr, "can't read %s\n", argv[1]);
+            return 2;
+        }
+        if (!loadDump(contents.data(), contents.size(), device, error)) {
+            fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+            return 2;
+        }
+    } else {
+        writeDataToEEPROM(true);
+    }
+
+    int controller;
+    std::string deviceName;
+    if (!openPseudoTerminal(controller, deviceName, error)) {
+        fprintf(stderr, "can't open a pseudo terminal: %s\n", error.c_str());
+        return 2;
+    }
+    // keep the terminal open ourselves, so reads don't fail between testers, and make it raw so nothing is echoed
+    int terminal = open(deviceName.c_str(), O_RDWR | O_NOCTTY);
+    if (terminal < 0 || !makeRaw(terminal, B115200, error)) {
+        fprintf(stderr, "%s: %s\n", deviceName.c_str(), terminal < 0 ? strerror(errno) : error.c_str());
+        return 2;
+    }
+    printf("%s\n", deviceName.c_str());
+    fflush(stdout);
+    serveVersionQueries(controller, -1);
+    return 0;
+}
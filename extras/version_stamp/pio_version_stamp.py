@@ -0,0 +1,90 @@
+"""PlatformIO pre-script: fills SOFTWARE_VERSION, SOFTWARE_DATE and SOFTWARE_BUILD_ID in CL_Version_Data.conf from
+git, like version_stamp.cmake does for CMake builds. Add it to the environment in platformio.ini:
+
+    extra_scripts = pre:.pio/libdeps/${this.__env__}/EEPROM Version Control/extras/version_stamp/pio_version_stamp.py
+
+It writes a copy of the conf to $BUILD_DIR/version_stamp/ and puts that directory in front of the include path.
+The conf is the project's include/CL_Version_Data.conf if there is one, else the library's, or the file named by
+`custom_version_stamp_conf`. The values only depend on the checked out commit (see version_stamp.cmake for the
+rules), and the copy is only rewritten when they change, so a no-op rebuild recompiles nothing.
+"""
+
+import glob
+import os
+import re
+import subprocess
+import time
+
+Import("env")  # noqa: F821 (provided by SCons)
+
+SOFTWARE_VERSION_CHARS = 7
+
+
+def git(*args):
+    return subprocess.check_output(["git"] + list(args), cwd=env.subst("$PROJECT_DIR"),  # noqa: F821
+                                   stderr=subprocess.DEVNULL).decode().strip()
+
+
+def find_conf():
+    configured = env.GetProjectOption("custom_version_stamp_conf", "")  # noqa: F821
+    candidates = [configured] if configured else []
+    candidates.append(os.path.join(env.subst("$PROJECT_INCLUDE_DIR"), "CL_Version_Data.conf"))  # noqa: F821
+    candidates += glob.glob(os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"),  # noqa: F821
+                                         "*", "src", "CL_Version_Data.conf"))
+    for candidate in candidates:
+        if os.path.isfile(candidate):
+            return candidate
+    raise SystemExit("pio_version_stamp.py: CL_Version_Data.conf not found, set custom_version_stamp_conf")
+
+
+def version_from_describe(describe, commit_hash):
+    match = re.match(r"^v?([0-9]+(?:\.[0-9]+)*)-([0-9]+)-g[0-9a-f]+$", describe)
+    if match:
+        version = match.group(1)
+        with_commits = version + "." + match.group(2)
+        if version.count(".") < 3 and len(with_commits) <= SOFTWARE_VERSION_CHARS:
+            version = with_commits
+    else:
+        match = re.match(r"^(.+)-[0-9]+-g[0-9a-f]+$", describe)
+        version = match.group(1) if match else commit_hash[:7]
+    # never cut a version short: "1.10.2." or "1.10.21" would name a release that doesn't exist
+    if len(version) > SOFTWARE_VERSION_CHARS:
+        raise SystemExit("pio_version_stamp.py: the tag \"%s\" is longer than the %d characters of SOFTWARE_VERSION"
+                         % (version, SOFTWARE_VERSION_CHARS))
+    return version
+
+
+def stamp(conf, constant, value):
+    return re.sub(r'(constexpr char %s\[\] *= *)"[^"]*"' % constant, lambda m: m.group(1) + '"%s"' % value, conf)
+
+
+def main():
+    conf_in = find_conf()
+    with open(conf_in) as f:
+        conf = f.read()
+
+    try:
+        commit_hash = git("rev-parse", "--short=12", "HEAD")
+    except (OSError, subprocess.CalledProcessError):
+        print("pio_version_stamp.py: not a git checkout, keeping the values from " + conf_in)
+    else:
+        describe = git("describe", "--tags", "--long", "--always")
+        git("update-index", "-q", "--refresh")
+        dirty = subprocess.call(["git", "diff-index", "--quiet", "HEAD", "--"],
+                                cwd=env.subst("$PROJECT_DIR")) != 0  # noqa: F821
+        epoch = int(os.environ.get("SOURCE_DATE_EPOCH") or git("log", "-1", "--format=%ct"))
+        date = time.gmtime(epoch)
+        conf = stamp(conf, "SOFTWARE_VERSION", version_from_describe(describe, commit_hash))
+        conf = stamp(conf, "SOFTWARE_DATE", "%s %d, %d" % (time.strftime("%B", date), date.tm_mday, date.tm_year))
+        conf = stamp(conf, "SOFTWARE_BUILD_ID", commit_hash + ("-dirty" if dirty else ""))
+
+    conf_dir = os.path.join(env.subst("$BUILD_DIR"), "version_stamp")  # noqa: F821
+    conf_out = os.path.join(conf_dir, "CL_Version_Data.conf")
+    if not os.path.isfile(conf_out) or open(conf_out).read() != conf:
+        os.makedirs(conf_dir, exist_ok=True)
+        with open(conf_out, "w") as f:
+            f.write(conf)
+    env.Prepend(CPPPATH=[conf_dir])  # noqa: F821
+
+
+main()
@@ -0,0 +1,91 @@
+# Writes a copy of CL_Version_Data.conf with SOFTWARE_VERSION, SOFTWARE_DATE and SOFTWARE_BUILD_ID taken from git.
+# Run at build time by eeprom_vc_version_stamp() (see CMakeLists.txt):
+#
+#     cmake -D CONF_IN=<conf> -D CONF_OUT=<generated conf> -D GIT_DIR=<checkout> -P version_stamp.cmake
+#
+# The values only depend on the checked out commit, never on the time of the build, so the output is rewritten
+# only when the commit (or the dirty state) changes and a no-op rebuild recompiles nothing:
+#
+#     SOFTWARE_VERSION   the last tag of `git describe --tags`, without a leading "v", with the number of commits
+#                        since that tag added as another component if the tag has fewer than 4 ("v1.2.0" and 3
+#                        commits give "1.2.0.3"). The abbreviated commit hash if there is no tag. At most 7
+#                        characters: if the commit count doesn't fit, the tag is used alone ("v1.10.2" and 15
+#                        commits give "1.10.2"), and a tag longer than that stops the build.
+#     SOFTWARE_DATE      the committer date of HEAD ("January 15, 2025"), or SOURCE_DATE_EPOCH if that is set.
+#     SOFTWARE_BUILD_ID  12 hex digits of the commit hash, with "-dirty" if there are uncommitted changes.
+#
+# Outside a git checkout, or without git, the values in CONF_IN are kept.
+
+foreach(var CONF_IN CONF_OUT GIT_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "version_stamp.cmake: ${var} is not set")
+    endif()
+endforeach()
+
+file(READ ${CONF_IN} conf)
+
+# replaces the string value of `constexpr char <constant>[] = "..."` in conf
+macro(stamp_string constant value)
+    string(REGEX REPLACE "(constexpr char ${constant}\\[\\] *= *)\"[^\"]*\"" "\\1\"${value}\"" conf "${conf}")
+endmacro()
+
+find_package(Git QUIET)
+if(GIT_FOUND)
+    execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --short=12 HEAD
+                    WORKING_DIRECTORY ${GIT_DIR} OUTPUT_VARIABLE hash RESULT_VARIABLE failed
+                    OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+endif()
+
+if(NOT GIT_FOUND OR failed)
+    message(STATUS "version_stamp.cmake: ${GIT_DIR} is not a git checkout, keeping the values from ${CONF_IN}")
+else()
+    execute_process(COMMAND ${GIT_EXECUTABLE} describe --tags --long --always
+                    WORKING_DIRECTORY ${GIT_DIR} OUTPUT_VARIABLE describe OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+    execute_process(COMMAND ${GIT_EXECUTABLE} log -1 --format=%ct
+                    WORKING_DIRECTORY ${GIT_DIR} OUTPUT_VARIABLE commit_time OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+    # refresh the index first, or files that were only touched (not changed) count as modified
+    execute_process(COMMAND ${GIT_EXECUTABLE} update-index -q --refresh
+                    WORKING_DIRECTORY ${GIT_DIR} OUTPUT_QUIET ERROR_QUIET)
+    execute_process(COMMAND ${GIT_EXECUTABLE} diff-index --quiet HEAD --
+                    WORKING_DIRECTORY ${GIT_DIR} RESULT_VARIABLE dirty OUTPUT_QUIET ERROR_QUIET)
+
+    # --long always gives <tag>-<commits>-g<hash>; without a tag it is just the hash
+    if(describe MATCHES "^v?([0-9]+(\\.[0-9]+)*)-([0-9]+)-g[0-9a-f]+$")
+        set(version ${CMAKE_MATCH_1})
+        set(commits_since_tag ${CMAKE_MATCH_3})
+        string(REGEX MATCHALL "\\." dots "${version}")
+        list(LENGTH dots dot_count)
+        string(LENGTH "${version}.${commits_since_tag}" length)
+        if(dot_count LESS 3 AND length LESS_EQUAL 7)
+            set(version "${version}.${commits_since_tag}")
+        endif()
+    elseif(describe MATCHES "^(.+)-[0-9]+-g[0-9a-f]+$")
+        set(version ${CMAKE_MATCH_1})       # a tag that isn't a version number is used as it is
+    else()
+        string(SUBSTRING ${hash} 0 7 version)
+    endif()
+    # never cut a version short: "1.10.2." or "1.10.21" would name a release that doesn't exist
+    string(LENGTH "${version}" length)
+    if(length GREATER 7)
+        message(FATAL_ERROR "version_stamp.cmake: the tag \"${version}\" is longer than the 7 characters of SOFTWARE_VERSION")
+    endif()
+
+    set(build_id ${hash})
+    if(dirty)
+        set(build_id "${hash}-dirty")
+    endif()
+
+    if(NOT DEFINED ENV{SOURCE_DATE_EPOCH})
+        set(ENV{SOURCE_DATE_EPOCH} ${commit_time})
+    endif()
+    string(TIMESTAMP date "%B %d, %Y" UTC)
+    string(REGEX REPLACE " 0([0-9]),"  " \\1," date "${date}")
+
+    stamp_string(SOFTWARE_VERSION "${version}")
+    stamp_string(SOFTWARE_DATE "${date}")
+    stamp_string(SOFTWARE_BUILD_ID "${build_id}")
+endif()
+
+# configure_file() leaves the output alone when its content is the same, so nothing that includes it is rebuilt
+file(WRITE ${CONF_OUT}.tmp "${conf}")
+configure_file(${CONF_OUT}.tmp ${CONF_OUT} COPYONLY)
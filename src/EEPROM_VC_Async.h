@@ -0,0 +1,313 @@
+/**
+ * Non-blocking version data writes for EEPROM_Version_Control.h.
+ *
+ * writeDataToEEPROM() keeps the CPU busy for the whole record, about 3.3 ms per byte written (around 180 ms for a
+ * fresh record). Sketches with a control loop can start the write with beginWriteVersionData() instead. It picks
+ * the slot and returns straight away; the bytes are then written one per step, in the same order and with the same
+ * diff as writeDataToEEPROM() (see recordWrite), while the sketch keeps running. A step happens
+ *  - on every pollWrite() call that finds the EEPROM ready, e.g. once per loop(),
+ *  - in the EEPROM ready interrupt, if EEPROM_VC_ASYNC_INTERRUPT is defined before this file is included (AVR).
+ *    The interrupt handler is defined here, so include this file with that macro from one .cpp file only.
+ *  - or several per service(budgetMicros) call, as many as fit in the time budget. This is for sketches that can't
+ *    use the interrupt but can afford a bounded stall per loop().
+ * isWriteComplete() tells when the record is committed, and an optional callback gets the WriteResult.
+ * remainingWriteBytes() says how many bytes are still to be written, e.g. to hold off a shutdown. In interrupt mode
+ * these hold off the interrupt for the few cycles it takes to read the write state.
+ *
+ * The handler only compares and writes bytes: the slot and the records to retire are chosen, with their CRCs, when
+ * the write starts. While it runs, the library's own reads (getVersionData(), readProjectName(), dataIsWritten(),
+ * ...) go through InternalEEPROMBackend::read(), which holds the interrupt off and waits for the byte being written,
+ * so they may be called. Sketch code that uses the EEPROM library directly (EEPROM.read(), EEPROM.get(), ...) sets
+ * the same EEAR register as the handler and can read the wrong byte: wait for isWriteComplete() first.
+ *
+ * Only one write can be in progress. Don't call the other write functions until it is complete. A RAM versionData
+ * passed to beginWriteVersionData() is read while the write goes on, so it has to stay valid (e.g. a global)
+ * until then; the overload without a struct writes the record image from flash and has no such restriction.
+ * With a backend that has no ready() (see EEPROM_VC_Backend.h), each step blocks like a normal write.
+ */
+
+#ifndef EEPROM_VC_ASYNC_H
+#define EEPROM_VC_ASYNC_H
+
+#include <EEPROM_Version_Control.h>
+#if defined(ARDUINO) && defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+// Runs the block after it with the EEPROM ready interrupt held off, so the loop never sees the write state half
+// updated by the interrupt handler (or the handler a half set up write). On a host build the simulated interrupt
+// only runs inside SimulatedEEPROM::advance(), never in the middle of a statement, so a plain block does the same.
+#if defined(ARDUINO) && defined(__AVR__)
+#define EEPROM_VC_ASYNC_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define EEPROM_VC_ASYNC_ATOMIC
+#endif
+
+namespace EEPROMVersionControl {
+
+    typedef void (*writeCompleteCallback)(const WriteResult &result);
+
+#ifdef EEPROM_VC_ASYNC_INTERRUPT
+    constexpr bool ASYNC_WRITE_USES_INTERRUPT = true;
+#else
+    constexpr bool ASYNC_WRITE_USES_INTERRUPT = false;
+#endif
+
+    // Backend::ready() and Backend::enableReadyInterrupt() if the backend has them
+    template <typename Backend>
+    auto backendReady(int) -> decltype(Backend::ready()) { return Backend::ready(); }
+    template <typename Backend>
+    bool backendReady(long) { return true; }
+
+    template <typename Backend>
+    auto backendEnableReadyInterrupt(bool enabled, int) -> decltype(Backend::enableReadyInterrupt(enabled)) {
+        Backend::enableReadyInterrupt(enabled);
+    }
+    template <typename Backend>
+    void backendEnableReadyInterrupt(bool, long) {}
+
+    /**
+     * @brief Where the asynchronous write is: the record, the step of the commit protocol and the byte in that step.
+     * In interrupt mode the handler changes it while the loop reads it, so the loop reads and sets it up inside
+     * EEPROM_VC_ASYNC_ATOMIC.
+     */
+    struct asyncWriteState {
+        recordWrite record;
+        volatile uint16_t step;         // recordWrite::STEP_COUNT when no write is in progress
+        uint8_t position;               // next byte of the step to compare
+        volatile uint16_t remaining;    // bytes still to be written
+        WriteResult result;
+        writeCompleteCallback onComplete;
+    };
+
+    inline asyncWriteState &asyncWrite() {
+        static asyncWriteState state = {recordWrite(), recordWrite::STEP_COUNT, 0, 0, {0, 0, false}, nullptr};
+        return state;
+    }
+
+    /**
+     * @brief true once the last write started with beginWriteVersionData() is committed (and if none was started).
+     */
+    inline bool isWriteComplete() {
+        uint16_t step;
+        EEPROM_VC_ASYNC_ATOMIC {
+            step = asyncWrite().step;
+        }
+        return step == recordWrite::STEP_COUNT;
+    }
+
+    /**
+     * @brief the bytes written so far by the current (or last) asynchronous write.
+     */
+    inline WriteResult asyncWriteProgress() {
+        WriteResult result;
+        EEPROM_VC_ASYNC_ATOMIC {
+            result = asyncWrite().result;
+        }
+        return result;
+    }
+
+    /**
+     * @brief the number of bytes still to be written by the current asynchronous write, counting the one being
+     * written, so it is at least 1 until the record is committed and 0 means it is safe to cut power. 0 if no write
+     * is in progress. Counted once when the write starts, so this doesn't touch the EEPROM.
+     */
+    inline uint16_t remainingWriteBytes() {
+        uint16_t remaining;
+        EEPROM_VC_ASYNC_ATOMIC {
+            remaining = asyncWrite().remaining;
+        }
+        return remaining;
+    }
+
+    /**
+     * @brief counts the bytes writeRecord() would write for `record`, without writing anything.
+     */
+    inline uint16_t countRecordWriteBytes(const recordWrite &record) {
+        uint16_t count = 0;
+        bool uncommitted = false;
+        for (uint16_t i = 0; i < recordWrite::STEP_COUNT; i++) {
+            uint16_t address;
+            ByteSource src;
+            uint8_t length;
+            record.step(i, address, src, length);
+            if (i == 0) {
+                uncommitted = (length == 1);
+            } else if (i == recordWrite::COMMIT_STEP && uncommitted) {
+                count++;        // the commit byte is cleared by step 0, so it is always written again
+                continue;
+            }
+            for (uint8_t j = 0; j < length; j++) {
+                if (Storage::read(address + j) != src[j]) count++;
+            }
+        }
+        return count;
+    }
+
+    inline void finishAsyncWrite() {
+        asyncWriteState &state = asyncWrite();
+        state.step = recordWrite::STEP_COUNT;
+        state.remaining = 0;
+        if (ASYNC_WRITE_USES_INTERRUPT) {
+            backendEnableReadyInterrupt<Storage>(false, 0);
+        }
+        if (state.result.bytesWritten > 0) {
+            backendCommit<Storage>(0);
+        }
+        if (state.onComplete) {
+            state.onComplete(state.result);
+        }
+    }
+
+    /**
+     * @brief starts the write of the next byte of the asynchronous write that doesn't already hold the right value.
+     * If the EEPROM is still busy, this waits for it (on AVR, in the EEPROM read), so callers check first. The byte
+     * started before is then done, and comes off `remaining`.
+     * @return `false` if no byte is left to write: the write is complete once the last one is done.
+     */
+    inline bool writeNextByte() {
+        asyncWriteState &state = asyncWrite();
+        uint16_t step = state.step;
+        uint8_t position = state.position;
+        while (step < recordWrite::STEP_COUNT) {
+            uint16_t address;
+            ByteSource src;
+            uint8_t length;
+            state.record.step(step, address, src, length);
+            while (position < length) {
+                const uint8_t i = position++;
+                if (Storage::read(address + i) != src[i]) {
+                    if (state.result.bytesWritten > 0 && state.remaining > 1) state.remaining = state.remaining - 1;
+                    Storage::write(address + i, src[i]);
+                    state.result.bytesWritten++;
+                    state.result.estimatedMicros += Storage::WRITE_TIME_US;
+                    state.step = step;
+                    state.position = position;
+                    return true;
+                }
+            }
+            step++;
+            position = 0;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Advances the asynchronous write by at most one byte.
+     *
+     * Does nothing while the EEPROM is still busy with the previous byte, so it never waits. Otherwise it skips the
+     * bytes that already hold the right value and starts the write of the next one that doesn't. Once the last byte
+     * has finished writing, the write is complete and the callback runs. Safe to call when no write is in progress.
+     *
+     * @return `true` while the write is still in progress.
+     */
+    inline bool pollWrite() {
+        asyncWriteState &state = asyncWrite();
+        if (state.step == recordWrite::STEP_COUNT) {
+            return false;
+        }
+        if (!backendReady<Storage>(0)) {
+            return true;
+        }
+        if (!writeNextByte()) {
+            finishAsyncWrite();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Advances the asynchronous write by as many bytes as fit in `budgetMicros`, for sketches without the
+     * ready interrupt. Call it once per loop().
+     *
+     * Starting a write when the EEPROM is ready costs no time, and every further byte waits about WRITE_TIME_US for
+     * the one before it, so a call writes up to 1 + budgetMicros / WRITE_TIME_US bytes (one less if the EEPROM is
+     * still busy from the last call) and stalls the loop for at most budgetMicros. A budget of 0 never waits, like
+     * pollWrite(). In interrupt mode the interrupt does the writing and this only reports.
+     *
+     * @return the number of bytes still to be written, 0 only once the record is committed (see remainingWriteBytes()).
+     */
+    inline uint16_t service(uint16_t budgetMicros) {
+        asyncWriteState &state = asyncWrite();
+        if (!ASYNC_WRITE_USES_INTERRUPT) {
+            uint32_t writes = budgetMicros / Storage::WRITE_TIME_US + (backendReady<Storage>(0) ? 1 : 0);
+            while (state.step != recordWrite::STEP_COUNT && writes > 0 && writeNextByte()) {
+                writes--;
+            }
+            pollWrite();        // completes the write once its last byte is done
+        }
+        return remainingWriteBytes();
+    }
+
+    /**
+     * @brief shared implementation of the beginWriteVersionData() overloads.
+     */
+    inline bool beginAsyncRecordWrite(ByteSource payload, uint16_t payloadCrc, bool overwrite, writeCompleteCallback onComplete) {
+        asyncWriteState &state = asyncWrite();
+        if (!isWriteComplete() || !backendReady<Storage>(0)) {
+            return false;
+        }
+        recordWrite record;
+        if (!planRecord(payload, RECORD_PAYLOAD_BYTES, payloadCrc, overwrite, DATA_EXISTS_MAGIC_NUMBER, record)) {
+            EEPROM_VC_ASYNC_ATOMIC {
+                state.result = WriteResult{0, 0, false};
+            }
+            if (onComplete) onComplete(WriteResult{0, 0, false});
+            return true;
+        }
+        const uint16_t remaining = countRecordWriteBytes(record);
+        EEPROM_VC_ASYNC_ATOMIC {
+            state.record = record;
+            state.result = WriteResult{0, 0, false};
+            state.onComplete = onComplete;
+            state.position = 0;
+            state.remaining = remaining;
+            state.step = 0;
+            if (ASYNC_WRITE_USES_INTERRUPT) {
+                backendEnableReadyInterrupt<Storage>(true, 0);
+            }
+        }
+        if (!ASYNC_WRITE_USES_INTERRUPT) {
+            pollWrite();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Starts writing version data to EEPROM without waiting for it.
+     *
+     * Same rules as writeDataToEEPROM(): nothing is written if data exists and `overwrite` is false, or if the
+     * newest record already holds this data. In that case the write is complete at once.
+     *
+     * @param dataBlock the data to store. Read while the write goes on, so it must stay valid until isWriteComplete().
+     *                  Its fingerprint is written as it is, so it must be current (see updateFingerprint()).
+     * @param overwrite Set to `true` to overwrite previously written data (default: `false`).
+     * @param onComplete called with the number of bytes written and the EEPROM time once the record is committed.
+     *                   In interrupt mode it runs inside the interrupt handler.
+     * @return `false` if a write is already in progress, the EEPROM is busy, or dataBlock.fingerprint is out of
+     *         date; nothing was started.
+     */
+    inline bool beginWriteVersionData(const versionData &dataBlock, bool overwrite = false, writeCompleteCallback onComplete = nullptr) {
+        if (!fingerprintIsCurrent(dataBlock)) {
+            return false;
+        }
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(&dataBlock) + RECORD_HEADER_BYTES;
+        return beginAsyncRecordWrite(ByteSource{payload, false}, crc16(payload, RECORD_PAYLOAD_BYTES), overwrite, onComplete);
+    }
+
+    /**
+     * @brief Starts writing the version data from CL_Version_Data.conf, copied from the record image in flash.
+     */
+    inline bool beginWriteVersionData(bool overwrite = false, writeCompleteCallback onComplete = nullptr) {
+        return beginAsyncRecordWrite(ByteSource{ConfiguredRecord::bytes + RECORD_HEADER_BYTES, true}, CONFIGURED_PAYLOAD_CRC,
+                                     overwrite, onComplete);
+    }
+}
+
+#if defined(EEPROM_VC_ASYNC_INTERRUPT) && defined(ARDUINO) && defined(EE_READY_vect)
+ISR(EE_READY_vect) {
+    EEPROMVersionControl::pollWrite();
+}
+#endif
+
+#endif // EEPROM_VC_ASYNC_H
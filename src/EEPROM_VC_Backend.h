@@ -0,0 +1,370 @@
+/**
+ * Storage backends for EEPROM_Version_Control.h.
+ *
+ * The library never touches the EEPROM object directly. Every byte goes through a backend type that provides
+ * two static functions:
+ *
+ *     static uint8_t read(uint16_t address);
+ *     static void write(uint16_t address, uint8_t value);     // one erase+write cycle of a single cell
+ *
+ * and a WRITE_TIME_US constant with the cost of one write (normally the write time of the Geometry, see
+ * EEPROM_VC_Geometry.h). Backends for parts that program a page at a time can also provide
+ *
+ *     static constexpr uint16_t MAX_BURST_BYTES = ...;         // most bytes one writePage() call takes
+ *     static bool writePage(uint16_t address, const uint8_t *bytes, uint8_t length);  // one write cycle, false if it failed
+ *
+ * and the library then writes changed bytes in bursts that never cross a Geometry page (see EEPROM_VC_External.h),
+ * and stops a record write before its commit byte if a burst fails.
+ * Backends whose write() only starts the write cycle can provide
+ *
+ *     static bool ready();                                     // true once the last write cycle is over
+ *     static void enableReadyInterrupt(bool enabled);          // the "EEPROM ready" interrupt, if there is one
+ *
+ * for the asynchronous writer in EEPROM_VC_Async.h. Backends whose writes only reach a RAM copy of the EEPROM
+ * (EEPROM emulated in flash, see EEPROM_VC_Flash.h) provide
+ *
+ *     static bool commit();                                    // writes the RAM copy back to flash
+ *
+ * and the library calls it once a record is committed.
+ * The backend is picked at compile time, so there is
+ * no runtime dispatch and no extra RAM on the microcontroller:
+ *  - On Arduino the default is InternalEEPROMBackend, which wraps the core's EEPROM library. Cores whose EEPROM
+ *    library needs begin() and commit() (ESP8266, ESP32, RP2040) have to select FlashEEPROMBackend instead, and
+ *    cores without an EEPROM library (SAMD, Due) another backend such as ExternalEEPROMBackend. <EEPROM.h> is only
+ *    included, and InternalEEPROMBackend only defined, when no backend is selected.
+ *  - On a host build the default is SimulatedEEPROMBackend, which forwards to a SimulatedEEPROM image that
+ *    models the AVR write time and counts wear per cell.
+ * To use something else, define EEPROM_VC_BACKEND as the name of your backend type before including
+ * EEPROM_Version_Control.h.
+ */
+
+#ifndef EEPROM_VC_BACKEND_H
+#define EEPROM_VC_BACKEND_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#ifndef EEPROM_VC_BACKEND       // the core's EEPROM library is only needed for the default backend
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040)
+#error "this core's EEPROM library needs EEPROM.begin() and EEPROM.commit(): select FlashEEPROMBackend, see EEPROM_VC_Flash.h"
+#endif
+#if defined(__has_include)
+#if !__has_include(<EEPROM.h>)
+#error "this core has no EEPROM library: select another backend, e.g. ExternalEEPROMBackend (see EEPROM_VC_External.h)"
+#endif
+#endif
+#include <EEPROM.h>
+#ifdef __AVR__
+#include <util/atomic.h>
+#endif
+#endif
+#else
+#include <EEPROM_VC_Host.h>
+#include <assert.h>
+#include <vector>
+#endif
+#include <EEPROM_VC_Geometry.h>
+
+namespace EEPROMVersionControl {
+
+#ifdef ARDUINO
+#ifndef EEPROM_VC_BACKEND
+
+    /**
+     * @brief Backend for the microcontroller's internal EEPROM, using the Arduino EEPROM library. Only defined when
+     * no other backend is selected, so cores without an EEPROM library can use another one.
+     */
+    struct InternalEEPROMBackend {
+        static constexpr uint32_t WRITE_TIME_US = Geometry::WRITE_TIME_US;
+
+#ifdef EERIE
+        /**
+         * @brief reads a byte with the ready interrupt held off. The asynchronous writer (EEPROM_VC_Async.h) sets EEAR
+         * in that interrupt, which would move a read half way through; held off, the read waits for the byte being
+         * written instead. Reads from the interrupt handler itself are not affected.
+         */
+        static uint8_t read(uint16_t address) {
+            uint8_t readyInterrupt;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                readyInterrupt = EECR & _BV(EERIE);
+                EECR &= ~_BV(EERIE);
+            }
+            const uint8_t value = EEPROM.read(address);
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                EECR |= readyInterrupt;
+            }
+            return value;
+        }
+#else
+        static uint8_t read(uint16_t address) {
+            return EEPROM.read(address);
+        }
+#endif
+
+        static void write(uint16_t address, uint8_t value) {
+            EEPROM.write(address, value);       // waits for the previous write, starts this one and returns
+        }
+
+#ifdef EERIE
+        static bool ready() {
+            return eeprom_is_ready();
+        }
+
+        static void enableReadyInterrupt(bool enabled) {
+            if (enabled) {
+                EECR |= _BV(EERIE);
+            } else {
+                EECR &= ~_BV(EERIE);
+            }
+        }
+#endif
+    };
+
+#define EEPROM_VC_BACKEND InternalEEPROMBackend
+#endif // EEPROM_VC_BACKEND
+
+#else // host build
+
+    /**
+     * @brief RAM-backed model of an EEPROM for host builds, sized and timed by the Geometry (an ATmega328P unless
+     * EEPROM_VC_GEOMETRY or E2END say otherwise).
+     *
+     * Cells start erased (0xFF). Every write is charged WRITE_TIME_US of simulated time and bumps the wear
+     * counter of that cell, so the cost of the library's write paths can be measured without hardware.
+     *
+     * Like the AVR, a write only starts the write cycle. The part is busy until WRITE_TIME_US later on a simulated
+     * clock, which moves forward with advance(). A write issued while the part is busy first waits for it, as
+     * EEPROM.write() does, and that wait is added to stalledMicros(). When the ready interrupt is enabled,
+     * advance() calls the handler given to setReadyVector() each time the part becomes ready, like EE_READY_vect.
+     * The image can be loaded from and saved to a raw binary file (same format as an avrdude raw dump).
+     */
+    class SimulatedEEPROM {
+    public:
+        static constexpr uint32_t WRITE_TIME_US = Geometry::WRITE_TIME_US;
+
+        explicit SimulatedEEPROM(size_t sizeBytes = Geometry::SIZE_BYTES)
+            : cells(sizeBytes, 0xFF), wearCounts(sizeBytes, 0) {}
+
+        uint8_t read(uint16_t address) {
+            assert(address < cells.size());
+            ++readCount;
+            return cells[address];
+        }
+
+        void write(uint16_t address, uint8_t value) {
+            assert(address < cells.size());
+            if (writeCount >= writeLimit) return;       // "power" is gone, see setWriteLimit()
+            if (clock < readyAt) {
+                stalled += readyAt - clock;
+                clock = readyAt;
+            }
+            pendingAddress = address;
+            pendingOldValue = cells[address];
+            cells[address] = value;
+            ++wearCounts[address];
+            ++writeCount;
+            simulatedMicros += WRITE_TIME_US;
+            readyAt = clock + WRITE_TIME_US;
+        }
+
+        /**
+         * @brief moves the simulated clock forward, running the ready interrupt handler whenever the part becomes
+         * ready while the interrupt is enabled. A handler that doesn't start a new write ends the loop (on the
+         * real part the interrupt would fire again straight away).
+         */
+        void advance(uint32_t micros) {
+            const uint64_t until = clock + micros;
+            while (readyInterrupt && readyVector && readyAt <= until) {
+                if (clock < readyAt) clock = readyAt;
+                const uint64_t before = readyAt;
+                readyVector();
+                if (readyAt == before) break;
+            }
+            if (clock < until) clock = until;
+        }
+
+        bool ready() const { return clock >= readyAt; }
+        void enableReadyInterrupt(bool enabled) { readyInterrupt = enabled; }
+        bool readyInterruptEnabled() const { return readyInterrupt; }
+        void setReadyVector(void (*handler)()) { readyVector = handler; }
+        uint64_t clockMicros() const { return clock; }
+        uint64_t stalledMicros() const { return stalled; }
+
+        size_t size() const { return cells.size(); }
+        uint32_t wear(uint16_t address) const { return wearCounts[address]; }
+        uint32_t bytesRead() const { return readCount; }
+        uint32_t bytesWritten() const { return writeCount; }
+        uint64_t elapsedMicros() const { return simulatedMicros; }
+
+        /**
+         * @brief highest wear count of any cell in [first, first + length)
+         */
+        uint32_t maxWear(uint16_t first = 0, size_t length = SIZE_MAX) const {
+            uint32_t worst = 0;
+            for (size_t i = first; i < cells.size() && i - first < length; i++) {
+                if (wearCounts[i] > worst) worst = wearCounts[i];
+            }
+            return worst;
+        }
+
+        /**
+         * @brief clears the read/write/time counters, but keeps the contents and the wear history
+         */
+        void resetStats() {
+            readCount = 0;
+            writeCount = 0;
+            simulatedMicros = 0;
+            stalled = 0;
+        }
+
+        /**
+         * @brief simulates a power failure: once `writes` more bytes have been written (counted from the last
+         * resetStats()), further writes are silently dropped. Pass UINT32_MAX to restore power.
+         */
+        void setWriteLimit(uint32_t writes) {
+            writeLimit = writes;
+        }
+
+        /**
+         * @brief simulates a power failure right now: a byte still in its write cycle (see ready()) keeps its old
+         * value, as if the cycle never happened. Power is back straight away and the part is ready.
+         */
+        void cutPower() {
+            if (clock < readyAt) {
+                cells[pendingAddress] = pendingOldValue;
+            }
+            readyAt = clock;
+        }
+
+        /**
+         * @brief returns the part to its factory state: all cells 0xFF, no wear, counters and clock cleared
+         */
+        void erase() {
+            cells.assign(cells.size(), 0xFF);
+            wearCounts.assign(wearCounts.size(), 0);
+            resetStats();
+            writeLimit = UINT32_MAX;
+            clock = 0;
+            readyAt = 0;
+            readyInterrupt = false;
+        }
+
+        /**
+         * @brief loads a raw image. Short files only fill the start of the EEPROM.
+         * @return false if the file could not be opened
+         */
+        bool loadImage(const char *path) {
+            FILE *file = fopen(path, "rb");
+            if (!file) return false;
+            size_t n = fread(cells.data(), 1, cells.size(), file);
+            fclose(file);
+            (void)n;
+            return true;
+        }
+
+        /**
+         * @brief loads a raw image from memory. Short images only fill the start of the EEPROM, the rest is erased.
+         */
+        void loadImage(const uint8_t *bytes, size_t length) {
+            cells.assign(cells.size(), 0xFF);
+            memcpy(cells.data(), bytes, (length < cells.size()) ? length : cells.size());
+        }
+
+        bool saveImage(const char *path) const {
+            FILE *file = fopen(path, "wb");
+            if (!file) return false;
+            bool ok = fwrite(cells.data(), 1, cells.size(), file) == cells.size();
+            return (fclose(file) == 0) && ok;
+        }
+
+        const uint8_t *data() const { return cells.data(); }
+
+        /**
+         * @brief the image that SimulatedEEPROMBackend currently talks to
+         */
+        static SimulatedEEPROM &active() {
+            return *activeSlot();
+        }
+
+        /**
+         * @brief routes SimulatedEEPROMBackend to the given image (e.g. a fresh one per benchmark case). The choice is
+         * per thread, so host tools can run the library on several images at once.
+         */
+        static void attach(SimulatedEEPROM &device) {
+            activeSlot() = &device;
+        }
+
+    private:
+        std::vector<uint8_t> cells;
+        std::vector<uint32_t> wearCounts;
+        uint32_t readCount = 0;
+        uint32_t writeCount = 0;
+        uint64_t simulatedMicros = 0;
+        uint32_t writeLimit = UINT32_MAX;
+        uint64_t clock = 0;
+        uint64_t readyAt = 0;
+        uint64_t stalled = 0;
+        uint16_t pendingAddress = 0;        // the last byte written, and its value before, for cutPower()
+        uint8_t pendingOldValue = 0xFF;
+        bool readyInterrupt = false;
+        void (*readyVector)() = nullptr;
+
+        static SimulatedEEPROM *&activeSlot() {
+            static SimulatedEEPROM defaultDevice;
+            static thread_local SimulatedEEPROM *current = &defaultDevice;
+            return current;
+        }
+    };
+
+    /**
+     * @brief Backend that forwards to SimulatedEEPROM::active().
+     */
+    struct SimulatedEEPROMBackend {
+        static constexpr uint32_t WRITE_TIME_US = SimulatedEEPROM::WRITE_TIME_US;
+
+        static uint8_t read(uint16_t address) {
+            return SimulatedEEPROM::active().read(address);
+        }
+
+        static void write(uint16_t address, uint8_t value) {
+            SimulatedEEPROM::active().write(address, value);
+        }
+
+        static bool ready() {
+            return SimulatedEEPROM::active().ready();
+        }
+
+        static void enableReadyInterrupt(bool enabled) {
+            SimulatedEEPROM::active().enableReadyInterrupt(enabled);
+        }
+    };
+
+#ifndef EEPROM_VC_BACKEND
+#define EEPROM_VC_BACKEND SimulatedEEPROMBackend
+#endif
+
+#endif // ARDUINO
+
+    using Storage = EEPROM_VC_BACKEND;     // the backend every read and write in this library goes through
+
+    /**
+     * @brief MAX_BURST_BYTES of a backend that has writePage(), 1 for backends that only write single bytes.
+     */
+    template <typename Backend, typename = void>
+    struct backendBurstBytes {
+        static constexpr uint16_t value = 1;
+    };
+    template <typename Backend>
+    struct backendBurstBytes<Backend, decltype(void(Backend::MAX_BURST_BYTES))> {
+        static constexpr uint16_t value = Backend::MAX_BURST_BYTES;
+    };
+
+    constexpr uint16_t STORAGE_BURST_BYTES = backendBurstBytes<Storage>::value;
+
+    // Backend::commit() if the backend has it; the writes of other backends are already in the EEPROM
+    template <typename Backend>
+    auto backendCommit(int) -> decltype(Backend::commit()) { return Backend::commit(); }
+    template <typename Backend>
+    bool backendCommit(long) { return true; }
+}
+
+#endif // EEPROM_VC_BACKEND_H
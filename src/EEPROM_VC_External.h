@@ -0,0 +1,261 @@
+/**
+ * Storage backend for external I2C EEPROMs (24LC32 to 24LC512 and compatible parts) for EEPROM_Version_Control.h.
+ *
+ * These parts program a whole page (32 to 128 bytes) in one write cycle of about 5 ms, the same time as a single
+ * byte. Writing the record a byte at a time, like the internal EEPROM, would take one cycle per byte. This backend
+ * has writePage(), so the library sends the changed bytes of each page as one burst (see writeBlock()), and it
+ * waits for the end of each write cycle by ACK polling: the part doesn't acknowledge its address until it is done,
+ * so there is no fixed delay.
+ *
+ * The geometry of the part and the backend are selected before any of the library headers are included:
+ *
+ *     #include <Wire.h>
+ *     #define EEPROM_VC_GEOMETRY EEPROMVersionControl::EEPROM24LC256Geometry
+ *     #define EEPROM_VC_BACKEND EEPROMVersionControl::ExternalEEPROMBackend<TwoWire>
+ *     #include <EEPROM_VC_External.h>
+ *     #include <EEPROM_Version_Control.h>
+ *
+ *     void setup() {
+ *         Wire.begin();
+ *         EEPROMVersionControl::ExternalEEPROMBackend<TwoWire>::attach(Wire);
+ *         EEPROMVersionControl::ensureVersionStamped();
+ *     }
+ *
+ * A burst also has to fit in the I2C library's transmit buffer (32 bytes on AVR, two of them for the address),
+ * so MAX_BURST_BYTES is the smaller of the page size and that buffer. A write the part doesn't acknowledge, or
+ * doesn't finish in time, makes writePage() return false, and the library then stops the record write before its
+ * commit byte. On a host build, SimulatedI2CEEPROM models such a part behind the same interface as TwoWire,
+ * including the page wraparound and the NACKs during a write cycle, so the backend can be tested without hardware.
+ */
+
+#ifndef EEPROM_VC_EXTERNAL_H
+#define EEPROM_VC_EXTERNAL_H
+
+#include <EEPROM_VC_Geometry.h>
+#ifndef ARDUINO
+#include <assert.h>
+#include <vector>
+#endif
+
+namespace EEPROMVersionControl {
+
+    constexpr uint8_t I2C_EEPROM_DEVICE_ADDRESS = 0x50;     // 24LCxx with A0..A2 tied low
+    constexpr uint8_t I2C_ADDRESS_BYTES = 2;                // memory address sent before the data, high byte first
+
+    /**
+     * @brief Backend for an external I2C EEPROM on `Bus` (TwoWire, or anything with the same interface).
+     *
+     * @tparam DeviceAddress 7 bit I2C address of the part.
+     * @tparam BusBufferBytes size of the bus library's transmit buffer.
+     */
+    template <typename Bus, uint8_t DeviceAddress = I2C_EEPROM_DEVICE_ADDRESS, uint8_t BusBufferBytes = 32>
+    struct ExternalEEPROMBackend {
+        static constexpr uint32_t WRITE_TIME_US = Geometry::WRITE_TIME_US;
+        static constexpr uint16_t MAX_BURST_BYTES = (Geometry::PAGE_BYTES < BusBufferBytes - I2C_ADDRESS_BYTES)
+                                                    ? Geometry::PAGE_BYTES : BusBufferBytes - I2C_ADDRESS_BYTES;
+        static constexpr uint16_t ACK_POLL_LIMIT = 1000;    // > 10 ms of polling even at 400 kHz, then give up
+
+        static_assert(Geometry::SIZE_BYTES > 2048, "ExternalEEPROMBackend needs a part with two address bytes (24LC32 or larger)");
+
+        /**
+         * @brief the bus the part is on. Call once in setup(), after Wire.begin().
+         */
+        static void attach(Bus &bus) {
+            busSlot() = &bus;
+        }
+
+        static uint8_t read(uint16_t address) {
+            Bus &bus = *busSlot();
+            bus.beginTransmission(DeviceAddress);
+            sendAddress(bus, address);
+            if (bus.endTransmission(false) != 0 || bus.requestFrom(DeviceAddress, static_cast<uint8_t>(1)) != 1) {
+                return 0xFF;        // no part on the bus reads like erased EEPROM
+            }
+            return bus.read();
+        }
+
+        static void write(uint16_t address, uint8_t value) {
+            writePage(address, &value, 1);
+        }
+
+        /**
+         * @brief programs `length` (at most MAX_BURST_BYTES) bytes in one write cycle and waits for it to finish.
+         * All of them must be on the same page, or the part wraps around to the start of the page.
+         * @return false if the part didn't acknowledge the write, or didn't finish it within ACK_POLL_LIMIT polls.
+         */
+        static bool writePage(uint16_t address, const uint8_t *bytes, uint8_t length) {
+            Bus &bus = *busSlot();
+            bus.beginTransmission(DeviceAddress);
+            sendAddress(bus, address);
+            bus.write(bytes, length);
+            if (bus.endTransmission() != 0) {
+                return false;
+            }
+            return waitUntilReady();
+        }
+
+        /**
+         * @brief ACK polling: addresses the part until it acknowledges, which it only does once the write cycle is over.
+         * @return false if it still hadn't answered after ACK_POLL_LIMIT tries.
+         */
+        static bool waitUntilReady() {
+            Bus &bus = *busSlot();
+            for (uint16_t i = 0; i < ACK_POLL_LIMIT; i++) {
+                bus.beginTransmission(DeviceAddress);
+                if (bus.endTransmission() == 0) return true;
+            }
+            return false;
+        }
+
+    private:
+        static void sendAddress(Bus &bus, uint16_t address) {
+            bus.write(static_cast<uint8_t>(address >> 8));
+            bus.write(static_cast<uint8_t>(address & 0xFF));
+        }
+
+        static Bus *&busSlot() {
+            static Bus *bus = nullptr;
+            return bus;
+        }
+    };
+
+#ifndef ARDUINO
+
+    /**
+     * @brief Host model of an I2C EEPROM, with the part of the TwoWire interface ExternalEEPROMBackend uses.
+     *
+     * Like the real part, a write transaction sets the address pointer from its first two bytes and programs the
+     * rest into the page the pointer is on, wrapping around at the end of the page. The part then NACKs its address
+     * for WRITE_TIME_US. Simulated time advances by BYTE_TIME_US per byte on the bus (address byte included), so
+     * ACK polling ends once the write cycle is over. Writes that wrapped are counted, since they mean a burst
+     * crossed a page boundary.
+     */
+    class SimulatedI2CEEPROM {
+    public:
+        static constexpr uint32_t WRITE_TIME_US = Geometry::WRITE_TIME_US;
+        static constexpr uint32_t BYTE_TIME_US = 23;        // 9 bits at 400 kHz
+        static constexpr uint8_t BUFFER_BYTES = 32;         // TwoWire transmit buffer on AVR
+
+        explicit SimulatedI2CEEPROM(size_t sizeBytes = Geometry::SIZE_BYTES, uint16_t pageBytes = Geometry::PAGE_BYTES,
+                                    uint8_t deviceAddress = I2C_EEPROM_DEVICE_ADDRESS)
+            : cells(sizeBytes, 0xFF), wearCounts(sizeBytes, 0), pageSize(pageBytes), address(deviceAddress) {}
+
+        // TwoWire interface
+        void beginTransmission(uint8_t deviceAddress) {
+            txAddress = deviceAddress;
+            txLength = 0;
+        }
+
+        size_t write(uint8_t value) {
+            if (txLength >= BUFFER_BYTES) return 0;
+            txBuffer[txLength++] = value;
+            return 1;
+        }
+
+        size_t write(const uint8_t *bytes, size_t length) {
+            size_t n = 0;
+            while (length--) n += write(*bytes++);
+            return n;
+        }
+
+        /**
+         * @return 0 on success, 2 if the part didn't acknowledge its address (wrong address or write cycle running).
+         */
+        uint8_t endTransmission(bool sendStop = true) {
+            (void)sendStop;
+            simulatedMicros += (1 + txLength) * BYTE_TIME_US;
+            if (txLength == 0) ++pollCount;
+            if (txAddress != address || busy()) return 2;
+            if (txLength > I2C_ADDRESS_BYTES && refuseAfter != NO_REFUSAL && refuseAfter-- == 0) {
+                ++refusedCount;
+                return 2;
+            }
+            if (txLength >= I2C_ADDRESS_BYTES) {
+                pointer = ((txBuffer[0] << 8) | txBuffer[1]) % cells.size();
+            }
+            if (txLength > I2C_ADDRESS_BYTES) {
+                program(txBuffer + I2C_ADDRESS_BYTES, txLength - I2C_ADDRESS_BYTES);
+            }
+            return 0;
+        }
+
+        uint8_t requestFrom(uint8_t deviceAddress, uint8_t quantity) {
+            simulatedMicros += (1 + quantity) * BYTE_TIME_US;
+            if (deviceAddress != address || busy()) return 0;
+            rxRemaining = quantity;
+            return quantity;
+        }
+
+        int available() const { return rxRemaining; }
+
+        int read() {
+            if (rxRemaining == 0) return -1;
+            --rxRemaining;
+            uint8_t value = cells[pointer];
+            pointer = (pointer + 1) % cells.size();
+            return value;
+        }
+
+        /**
+         * @brief makes the part NACK one write transaction, once `pageWrites` more have gone through (e.g. a brownout
+         * or a glitch on the bus). Addressing, polls and reads are still acknowledged.
+         */
+        void refuseWriteAfter(uint32_t pageWrites) {
+            refuseAfter = pageWrites;
+        }
+
+        // inspection
+        size_t size() const { return cells.size(); }
+        uint8_t peek(uint16_t cell) const { return cells[cell]; }
+        uint32_t wear(uint16_t cell) const { return wearCounts[cell]; }
+        bool busy() const { return simulatedMicros < busyUntil; }
+        uint32_t pageWrites() const { return pageWriteCount; }
+        uint32_t bytesWritten() const { return writeCount; }
+        uint32_t wrappedWrites() const { return wrapCount; }
+        uint32_t acknowledgePolls() const { return pollCount; }
+        uint32_t refusedWrites() const { return refusedCount; }
+        uint64_t elapsedMicros() const { return simulatedMicros; }
+
+    private:
+        std::vector<uint8_t> cells;
+        std::vector<uint32_t> wearCounts;
+        uint16_t pageSize;
+        uint8_t address;
+        uint8_t txAddress = 0;
+        uint8_t txBuffer[BUFFER_BYTES];
+        uint8_t txLength = 0;
+        uint8_t rxRemaining = 0;
+        size_t pointer = 0;
+        uint64_t simulatedMicros = 0;
+        uint64_t busyUntil = 0;
+        uint32_t pageWriteCount = 0;
+        uint32_t writeCount = 0;
+        uint32_t wrapCount = 0;
+        uint32_t pollCount = 0;
+        static constexpr uint32_t NO_REFUSAL = UINT32_MAX;
+        uint32_t refuseAfter = NO_REFUSAL;
+        uint32_t refusedCount = 0;
+
+        void program(const uint8_t *bytes, size_t length) {
+            const size_t pageStart = pointer / pageSize * pageSize;
+            bool wrapped = false;
+            for (size_t i = 0; i < length; i++) {
+                size_t offset = pointer - pageStart + i;
+                wrapped |= offset >= pageSize;
+                size_t cell = pageStart + offset % pageSize;
+                assert(cell < cells.size());
+                cells[cell] = bytes[i];
+                ++wearCounts[cell];
+            }
+            pointer = pageStart + (pointer - pageStart + length) % pageSize;
+            wrapCount += wrapped;
+            writeCount += length;
+            ++pageWriteCount;
+            busyUntil = simulatedMicros + WRITE_TIME_US;
+        }
+    };
+
+#endif // ARDUINO
+}
+
+#endif // EEPROM_VC_EXTERNAL_H
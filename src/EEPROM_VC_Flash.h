@@ -0,0 +1,163 @@
+/**
+ * Storage backend for EEPROM emulated in flash by cores whose EEPROM library keeps a RAM copy (ESP8266, ESP32,
+ * RP2040), for EEPROM_Version_Control.h.
+ *
+ * On those cores EEPROM.begin(size) loads the RAM copy from flash, EEPROM.write() only changes the RAM copy, and
+ * nothing reaches flash until EEPROM.commit(), which erases and reprograms the flash sector holding it.
+ * InternalEEPROMBackend calls neither, so the library refuses to build with it on those cores (see
+ * EEPROM_VC_Backend.h). This backend calls begin() once, in attach(), and has commit(), which the library calls
+ * once the commit byte of a record is written (see writeRecord()). A record then costs one flash write however
+ * many bytes changed, and a reset before that commit leaves the old record in flash. WriteResult estimates still
+ * charge every changed byte the write time of the geometry, so they are an upper bound.
+ *
+ * The geometry of the emulated EEPROM and the backend are selected before any of the library headers are included:
+ *
+ *     #include <EEPROM.h>
+ *     #define EEPROM_VC_GEOMETRY EEPROMVersionControl::emulatedEEPROMGeometry<1024, 4096, 40000>
+ *     #define EEPROM_VC_BACKEND EEPROMVersionControl::FlashEEPROMBackend<EEPROMClass>
+ *     #include <EEPROM_VC_Flash.h>
+ *     #include <EEPROM_Version_Control.h>
+ *
+ *     void setup() {
+ *         EEPROMVersionControl::FlashEEPROMBackend<EEPROMClass>::attach(EEPROM);
+ *         EEPROMVersionControl::ensureVersionStamped();
+ *     }
+ *
+ * Whether a reset during commit() itself can lose the flash copy depends on the core. On a host build,
+ * SimulatedFlashEEPROM models such an EEPROM library behind the same interface as EEPROMClass, so the backend can
+ * be tested without hardware.
+ */
+
+#ifndef EEPROM_VC_FLASH_H
+#define EEPROM_VC_FLASH_H
+
+#include <EEPROM_VC_Geometry.h>
+#ifndef ARDUINO
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+#endif
+
+namespace EEPROMVersionControl {
+
+    /**
+     * @brief Backend for an EEPROM library with begin() and commit() (EEPROMClass, or anything with the same
+     * interface).
+     */
+    template <typename EEPROMLibrary>
+    struct FlashEEPROMBackend {
+        static constexpr uint32_t WRITE_TIME_US = Geometry::WRITE_TIME_US;
+
+        /**
+         * @brief the EEPROM library to use. Call once in setup(), before any other library call: this loads the
+         * RAM copy of the whole Geometry::SIZE_BYTES from flash.
+         */
+        static void attach(EEPROMLibrary &eeprom) {
+            eepromSlot() = &eeprom;
+            eeprom.begin(Geometry::SIZE_BYTES);
+        }
+
+        static uint8_t read(uint16_t address) {
+            return eepromSlot()->read(address);
+        }
+
+        static void write(uint16_t address, uint8_t value) {
+            eepromSlot()->write(address, value);       // the RAM copy only, see commit()
+        }
+
+        /**
+         * @brief writes the RAM copy back to flash, if it changed since the last commit.
+         * @return false if the core couldn't write the flash.
+         */
+        static bool commit() {
+            return eepromSlot()->commit();
+        }
+
+    private:
+        static EEPROMLibrary *&eepromSlot() {
+            static EEPROMLibrary *eeprom = nullptr;
+            return eeprom;
+        }
+    };
+
+#ifndef ARDUINO
+
+    /**
+     * @brief Host model of an EEPROM library that emulates EEPROM in flash, with the part of the EEPROMClass
+     * interface FlashEEPROMBackend uses.
+     *
+     * begin() loads the RAM copy from the flash image, read() and write() use the RAM copy, and commit() erases and
+     * reprograms every flash sector of `sectorBytes` whose bytes changed. reset() models a reset: the RAM copy is
+     * lost and only what was committed remains. setCommitLimit() models a power failure before a commit.
+     */
+    class SimulatedFlashEEPROM {
+    public:
+        explicit SimulatedFlashEEPROM(size_t sizeBytes = Geometry::SIZE_BYTES, uint16_t sectorBytes = Geometry::ERASE_BYTES)
+            : flash(sizeBytes, 0xFF), sectorSize(sectorBytes) {}
+
+        // EEPROMClass interface
+        void begin(size_t size) {
+            assert(size <= flash.size());
+            copy.assign(flash.begin(), flash.begin() + size);
+            ++beginCount;
+        }
+
+        uint8_t read(int address) {
+            assert(static_cast<size_t>(address) < copy.size());     // also catches a read before begin()
+            return copy[address];
+        }
+
+        void write(int address, uint8_t value) {
+            assert(static_cast<size_t>(address) < copy.size());
+            copy[address] = value;
+        }
+
+        bool commit() {
+            if (commitCount >= commitLimit) return false;     // "power" is gone, see setCommitLimit()
+            ++commitCount;
+            for (size_t sector = 0; sector < copy.size(); sector += sectorSize) {
+                const size_t end = (sector + sectorSize < copy.size()) ? sector + sectorSize : copy.size();
+                if (!std::equal(copy.begin() + sector, copy.begin() + end, flash.begin() + sector)) {
+                    std::copy(copy.begin() + sector, copy.begin() + end, flash.begin() + sector);
+                    ++sectorWriteCount;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief a reset: the RAM copy is gone until the next begin(), the flash keeps what was committed.
+         */
+        void reset() {
+            copy.clear();
+        }
+
+        /**
+         * @brief simulates a power failure: once `commits` more commits have been made, further commits write
+         * nothing and return false. Pass UINT32_MAX to restore power.
+         */
+        void setCommitLimit(uint32_t commits) {
+            commitLimit = (commits == UINT32_MAX) ? UINT32_MAX : commitCount + commits;
+        }
+
+        // inspection
+        size_t size() const { return flash.size(); }
+        uint8_t peek(uint16_t address) const { return flash[address]; }
+        uint32_t begins() const { return beginCount; }
+        uint32_t commits() const { return commitCount; }
+        uint32_t sectorWrites() const { return sectorWriteCount; }
+
+    private:
+        std::vector<uint8_t> flash;
+        std::vector<uint8_t> copy;
+        uint16_t sectorSize;
+        uint32_t beginCount = 0;
+        uint32_t commitCount = 0;
+        uint32_t commitLimit = UINT32_MAX;
+        uint32_t sectorWriteCount = 0;
+    };
+
+#endif // ARDUINO
+}
+
+#endif // EEPROM_VC_FLASH_H
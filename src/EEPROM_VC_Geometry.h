@@ -0,0 +1,91 @@
+/**
+ * EEPROM geometry descriptors for EEPROM_Version_Control.h.
+ *
+ * A geometry describes the part the version data is stored on:
+ *
+ *     SIZE_BYTES       number of bytes of EEPROM (E2END + 1 on AVR)
+ *     PAGE_BYTES       most bytes one write operation can program. 1 for parts that are written a byte at a time
+ *     ERASE_BYTES      smallest block the part erases at once. 1 for byte-erasable EEPROM, a flash page or row
+ *                      for EEPROM emulated in flash
+ *     WRITE_TIME_US    time of one write operation (one byte, or one page when PAGE_BYTES > 1)
+ *
+ * The library uses it to place the version data region (see the slot layout in EEPROM_Version_Control.h): slots
+ * start on a page boundary, and the region starts on an erase block boundary when it spans at least one block.
+ * The backends take their write time from it.
+ *
+ * The geometry is picked at compile time. By default it is InternalEEPROMGeometry, built from the E2END of the
+ * target's avr-libc headers, so the ATmega328P, ATmega2560, ATtiny and other AVR parts need no setup. Cores that
+ * don't define E2END, or other parts, need EEPROM_VC_GEOMETRY defined as a geometry type before
+ * EEPROM_Version_Control.h is included, e.g. for a core that emulates 1 KB of EEPROM in 256 byte flash rows (cores
+ * whose EEPROM library needs begin() and commit() also need the backend from EEPROM_VC_Flash.h):
+ *
+ *     #define EEPROM_VC_GEOMETRY EEPROMVersionControl::emulatedEEPROMGeometry<1024, 256, 8000>
+ *     #include <EEPROM_Version_Control.h>
+ *
+ * Where the version data goes inside the EEPROM is set in CL_Version_Data.conf (VERSION_DATA_BASE_ADDRESS and
+ * VERSION_DATA_RESERVED_BYTES).
+ */
+
+#ifndef EEPROM_VC_GEOMETRY_H
+#define EEPROM_VC_GEOMETRY_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <EEPROM_VC_Host.h>
+#endif
+
+namespace EEPROMVersionControl {
+
+    constexpr uint32_t AVR_EEPROM_WRITE_TIME_US = 3300;     // erase + write of one byte on the AVR internal EEPROM (datasheet: ~3.3 ms)
+
+    /**
+     * @brief Compile-time description of an EEPROM. See the top of this file for the fields.
+     */
+    template <uint32_t SizeBytes, uint16_t PageBytes, uint16_t EraseBytes, uint32_t WriteTimeUs>
+    struct eepromGeometry {
+        static constexpr uint32_t SIZE_BYTES = SizeBytes;
+        static constexpr uint16_t PAGE_BYTES = PageBytes;
+        static constexpr uint16_t ERASE_BYTES = EraseBytes;
+        static constexpr uint32_t WRITE_TIME_US = WriteTimeUs;
+
+        static_assert(SizeBytes > 0 && SizeBytes <= 0x10000UL, "EEPROM addresses are 16 bits, so at most 64 KB can be used");
+        static_assert(PageBytes > 0 && (PageBytes & (PageBytes - 1)) == 0, "PAGE_BYTES must be a power of 2");
+        static_assert(EraseBytes > 0 && (EraseBytes & (EraseBytes - 1)) == 0, "ERASE_BYTES must be a power of 2");
+    };
+
+    // AVR internal EEPROM. Pages only exist for the programmer; the CPU writes single bytes.
+    typedef eepromGeometry<1024, 1, 1, AVR_EEPROM_WRITE_TIME_US> ATmega328PGeometry;
+    typedef eepromGeometry<4096, 1, 1, AVR_EEPROM_WRITE_TIME_US> ATmega2560Geometry;
+    typedef eepromGeometry<512, 1, 1, AVR_EEPROM_WRITE_TIME_US> ATtiny85Geometry;
+
+    // external I2C EEPROMs (see EEPROM_VC_External.h). A page write takes as long as a single byte write.
+    typedef eepromGeometry<8192, 32, 1, 5000> EEPROM24LC64Geometry;
+    typedef eepromGeometry<32768, 64, 1, 5000> EEPROM24LC256Geometry;
+    typedef eepromGeometry<65536, 128, 1, 5000> EEPROM24LC512Geometry;
+
+    /**
+     * @brief EEPROM emulated in flash: every byte write erases and reprograms a whole flash row of `RowBytes`,
+     * which takes `RowWriteTimeUs`. Cores that keep a RAM copy and write it back on EEPROM.commit() also need
+     * FlashEEPROMBackend (see EEPROM_VC_Flash.h).
+     */
+    template <uint32_t SizeBytes, uint16_t RowBytes, uint32_t RowWriteTimeUs>
+    using emulatedEEPROMGeometry = eepromGeometry<SizeBytes, 1, RowBytes, RowWriteTimeUs>;
+
+#ifdef E2END
+    // the internal EEPROM of the part being compiled for (E2END is the last valid EEPROM address)
+    typedef eepromGeometry<static_cast<uint32_t>(E2END) + 1, 1, 1, AVR_EEPROM_WRITE_TIME_US> InternalEEPROMGeometry;
+#endif
+
+#ifndef EEPROM_VC_GEOMETRY
+#ifdef E2END
+#define EEPROM_VC_GEOMETRY InternalEEPROMGeometry
+#else
+#error "This core doesn't define E2END. Define EEPROM_VC_GEOMETRY (see EEPROM_VC_Geometry.h) before including EEPROM_Version_Control.h."
+#endif
+#endif
+
+    using Geometry = EEPROM_VC_GEOMETRY;   // the part the version data is stored on
+}
+
+#endif // EEPROM_VC_GEOMETRY_H
@@ -0,0 +1,348 @@
+/**
+ * History log of previous version records for EEPROM_Version_Control.h.
+ *
+ * writeDataToEEPROM(data, true) replaces the stored record, so the versions a unit ran before are gone.
+ * writeDataToEEPROMWithHistory() keeps them: before the new record is written, the bytes of the current record
+ * that are about to change are appended to a circular log of VERSION_HISTORY_DEPTH entries. The log sits
+ * directly below the version data slots (see CL_Version_Data.conf).
+ *
+ * Entries are reverse deltas. Each one holds the older values of the bytes that changed, as runs of
+ *
+ *     [offset in the payload: 1 byte][count: 1 byte][older bytes: count bytes]
+ *
+ * so a new software version and date cost a few bytes, not a whole record. The newest version is always the
+ * record in the version data slots. versionHistoryIterator starts there and applies one entry per step, so
+ * walking the history newest first needs one versionData in RAM, no matter how deep the log is. When the log
+ * is full, the oldest entry is overwritten.
+ *
+ * Each entry has a sequence number and the CRC-16 of the payload before and after the change. A walk only
+ * applies an entry to the version it was made from, and it checks the result. Entries from an interrupted
+ * append, or from before a plain writeDataToEEPROM() call, are skipped instead of producing a wrong version.
+ * A change too big for one entry is split over several; the iterator applies those together.
+ *
+ * Only versionData records (DATA_EXISTS_MAGIC_NUMBER) have a history.
+ */
+
+#ifndef EEPROM_VC_HISTORY_H
+#define EEPROM_VC_HISTORY_H
+
+#include <EEPROM_Version_Control.h>
+
+namespace EEPROMVersionControl {
+
+    /**
+     * @brief The start of every history entry. The delta runs follow it.
+     */
+    struct historyEntryHeader {
+        uint16_t sequence;             // increases by one per entry, like the slot sequence numbers
+        uint16_t newerCrc;             // CRC-16 of the payload this entry is applied to
+        uint16_t olderCrc;             // CRC-16 of the payload after applying it
+        uint8_t length;                // commit byte: delta bytes + 1, plus HISTORY_CONTINUED. 0 while being written
+    };
+
+    constexpr uint16_t HISTORY_ENTRY_HEADER_BYTES = offsetof(historyEntryHeader, length) + 1;
+    constexpr uint8_t HISTORY_ENTRY_CAPACITY = VERSION_HISTORY_ENTRY_BYTES - HISTORY_ENTRY_HEADER_BYTES;   // delta bytes per entry
+    constexpr uint8_t HISTORY_CONTINUED = 0x80;     // set in length: the change continues in the next older entry
+    constexpr uint16_t HISTORY_REGION_BYTES = VERSION_HISTORY_DEPTH * VERSION_HISTORY_ENTRY_BYTES;
+    constexpr uint16_t HISTORY_REGION_START = VERSION_DATA_REGION_START - HISTORY_REGION_BYTES;
+
+    static_assert(VERSION_HISTORY_ENTRY_BYTES >= HISTORY_ENTRY_HEADER_BYTES + 3 && VERSION_HISTORY_ENTRY_BYTES < HISTORY_CONTINUED,
+                  "VERSION_HISTORY_ENTRY_BYTES must be between 10 and 127");
+    static_assert(VERSION_HISTORY_DEPTH < NO_SLOT, "VERSION_HISTORY_DEPTH must be below 255");
+    static_assert(HISTORY_REGION_BYTES <= VERSION_DATA_REGION_START, "the version history does not fit in the EEPROM!");
+
+    /**
+     * @brief EEPROM address of a history entry.
+     */
+    constexpr uint16_t historyEntryAddress(uint8_t entry) {
+        return HISTORY_REGION_START + entry * VERSION_HISTORY_ENTRY_BYTES;
+    }
+
+    constexpr uint8_t nextHistoryEntry(uint8_t entry) {
+        return (entry + 1 >= VERSION_HISTORY_DEPTH) ? 0 : entry + 1;
+    }
+
+    constexpr uint8_t previousHistoryEntry(uint8_t entry) {
+        return (entry == 0) ? VERSION_HISTORY_DEPTH - 1 : entry - 1;
+    }
+
+    /**
+     * @brief reads the header of an entry.
+     * @return true if the entry is committed and its length is in range.
+     */
+    inline bool readHistoryEntry(uint8_t entry, historyEntryHeader &header) {
+        readBlock(historyEntryAddress(entry), &header, HISTORY_ENTRY_HEADER_BYTES);
+        uint8_t deltaLength = header.length & ~HISTORY_CONTINUED;
+        return deltaLength >= 1 && deltaLength <= HISTORY_ENTRY_CAPACITY + 1;
+    }
+
+    /**
+     * @brief finds the most recently appended history entry in one pass over the log.
+     * @param sequence set to its sequence number (untouched if the log is empty).
+     * @return the entry index, or NO_SLOT if the log is empty.
+     */
+    inline uint8_t findNewestHistoryEntry(uint16_t &sequence) {
+        uint8_t newest = NO_SLOT;
+        historyEntryHeader header;
+        for (uint8_t entry = 0; entry < VERSION_HISTORY_DEPTH; entry++) {
+            if (!readHistoryEntry(entry, header)) continue;
+            if (newest == NO_SLOT || sequenceIsNewer(header.sequence, sequence)) {
+                newest = entry;
+                sequence = header.sequence;
+            }
+        }
+        return newest;
+    }
+
+    /**
+     * @brief finds the highest run of payload bytes below `end` where the stored record differs from `newer`.
+     *
+     * Runs of differences separated by 2 or fewer equal bytes are merged, since a new run costs 2 bytes.
+     *
+     * @return false if there is no difference below `end`.
+     */
+    inline bool previousDeltaRun(uint16_t olderAddress, ByteSource newer, uint8_t end, uint8_t &start, uint8_t &count) {
+        uint8_t i = end;
+        while (i > 0 && Storage::read(olderAddress + i - 1) == newer[i - 1]) i--;
+        if (i == 0) {
+            return false;
+        }
+        end = i;
+        start = i - 1;
+        for (uint8_t j = start; j > 0 && j + 3 > start; j--) {
+            if (Storage::read(olderAddress + j - 1) != newer[j - 1]) start = j - 1;
+        }
+        count = end - start;
+        return true;
+    }
+
+    /**
+     * @brief CRC-16 of the payload with the stored bytes below `split` and the bytes of `newer` from `split` on.
+     * These are the in-between versions of a change that is split over several entries.
+     */
+    inline uint16_t splitPayloadCrc(uint16_t olderAddress, ByteSource newer, uint8_t split) {
+        uint16_t crc = CRC16_INITIAL_VALUE;
+        for (uint8_t i = 0; i < RECORD_PAYLOAD_BYTES; i++) {
+            crc = crc16Update(crc, (i < split) ? Storage::read(olderAddress + i) : newer[i]);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief writes one history entry, using the same commit order as writeRecord(): the length byte is cleared
+     * first and written last, and not at all if a write before it failed.
+     */
+    inline WriteResult writeHistoryEntry(uint8_t entry, const historyEntryHeader &header, const uint8_t *delta, uint8_t deltaLength) {
+        const uint16_t address = historyEntryAddress(entry);
+        const uint16_t commitAddress = address + offsetof(historyEntryHeader, length);
+
+        WriteResult result = {0, 0, false};
+        if (Storage::read(commitAddress) != UNCOMMITTED_MARKER) {
+            result += writeBlock(commitAddress, uncommittedMarker(), 1);
+        }
+        if (!result.failed) result += writeBlock(address, &header, offsetof(historyEntryHeader, length));
+        if (!result.failed) result += writeBlock(address + HISTORY_ENTRY_HEADER_BYTES, delta, deltaLength);
+        if (!result.failed) result += writeBlock(commitAddress, &header.length, 1);     // commit
+        return result;
+    }
+
+    /**
+     * @brief encodes the change from the stored payload at `olderAddress` to `newer` as history entries.
+     *
+     * The payload is covered from the end down, so the first entry produced holds the highest offsets. It is
+     * the one applied last when walking back, so it is written first, with the lowest sequence number.
+     *
+     * @param entries set to the number of entries the change needs.
+     * @param firstEntry, sequence where to write the first entry and its sequence number. Ignored unless `write`.
+     * @param write false to only count the entries.
+     */
+    inline WriteResult encodeHistory(uint16_t olderAddress, ByteSource newer, uint16_t olderCrc, bool write,
+                                     uint8_t &entries, uint8_t firstEntry = 0, uint16_t sequence = 0) {
+        WriteResult result = {0, 0, false};
+        uint8_t delta[HISTORY_ENTRY_CAPACITY];
+        uint8_t end = RECORD_PAYLOAD_BYTES;     // everything from `end` up is covered by earlier entries
+        uint8_t start, count;
+        entries = 0;
+
+        while (previousDeltaRun(olderAddress, newer, end, start, count)) {
+            uint8_t length = 0;
+            while (length + 3 <= HISTORY_ENTRY_CAPACITY && previousDeltaRun(olderAddress, newer, end, start, count)) {
+                uint8_t take = (count < HISTORY_ENTRY_CAPACITY - length - 2) ? count : HISTORY_ENTRY_CAPACITY - length - 2;
+                start += count - take;
+                delta[length++] = start;
+                delta[length++] = take;
+                readBlock(olderAddress + start, delta + length, take);
+                length += take;
+                end = start;
+            }
+
+            uint16_t newerCrc = splitPayloadCrc(olderAddress, newer, end);
+            if (write) {
+                historyEntryHeader header = {static_cast<uint16_t>(sequence + entries), newerCrc, olderCrc,
+                                             static_cast<uint8_t>((length + 1) | (entries ? HISTORY_CONTINUED : 0))};
+                result += writeHistoryEntry(firstEntry, header, delta, length);
+                if (result.failed) return result;
+                firstEntry = nextHistoryEntry(firstEntry);
+            }
+            olderCrc = newerCrc;
+            entries++;
+        }
+        return result;
+    }
+
+    /**
+     * @brief shared implementation of the writeDataToEEPROMWithHistory() overloads.
+     */
+    inline WriteResult storeRecordWithHistory(ByteSource payload, uint16_t payloadCrc, bool *historyRecorded) {
+        WriteResult result = {0, 0, false};
+        bool recorded = false;
+        uint8_t newest = findNewestSlot();
+
+        if (VERSION_HISTORY_DEPTH > 0 && newest != NO_SLOT) {
+            const uint16_t olderAddress = recordAddress(newest) + RECORD_HEADER_BYTES;
+            uint16_t olderCrc;
+            readBlock(recordAddress(newest) + offsetof(recordHeader, crc), &olderCrc, sizeof(olderCrc));
+
+            uint8_t entries;
+            encodeHistory(olderAddress, payload, olderCrc, false, entries);
+            if (entries > 0 && entries <= VERSION_HISTORY_DEPTH) {
+                uint16_t sequence = 0;
+                uint8_t newestEntry = findNewestHistoryEntry(sequence);
+                uint8_t firstEntry = (newestEntry == NO_SLOT) ? 0 : nextHistoryEntry(newestEntry);
+                sequence = (newestEntry == NO_SLOT) ? 0 : sequence + 1;
+                result += encodeHistory(olderAddress, payload, olderCrc, true, entries, firstEntry, sequence);
+                recorded = !result.failed;
+            }
+        }
+        if (result.failed) {
+            if (historyRecorded) *historyRecorded = false;
+            return result;      // the record is only replaced once its history is stored
+        }
+
+        result += storeRecord(payload, RECORD_PAYLOAD_BYTES, payloadCrc, true);
+        if (historyRecorded) *historyRecorded = recorded;
+        return result;
+    }
+
+    /**
+     * @brief Writes version data to EEPROM and keeps the version it replaces in the history log.
+     *
+     * Works like writeDataToEEPROM(dataBlock, true). If a different record is already stored, the bytes that
+     * change are appended to the history first. Nothing at all is written if the stored record is identical.
+     *
+     * @param dataBlock The struct of type `versionData` containing the information to store.
+     * @param historyRecorded if not null, set to `true` if the previous version went into the history. It is
+     *                        `false` if there was nothing to record, VERSION_HISTORY_DEPTH is 0, or the change needs
+     *                        more than VERSION_HISTORY_DEPTH entries.
+     * @return the number of bytes written (history and record) and the estimated EEPROM write time.
+     */
+    inline WriteResult writeDataToEEPROMWithHistory(const versionData &dataBlock, bool *historyRecorded = nullptr) {
+        versionData record = dataBlock;     // the stored fingerprint is always that of the values written
+        updateFingerprint(record);
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(&record) + RECORD_HEADER_BYTES;
+        return storeRecordWithHistory(ByteSource{payload, false}, crc16(payload, RECORD_PAYLOAD_BYTES), historyRecorded);
+    }
+
+    /**
+     * @brief Writes the version data from CL_Version_Data.conf (straight from flash, see writeDataToEEPROM(bool))
+     * and keeps the version it replaces in the history log.
+     */
+    inline WriteResult writeDataToEEPROMWithHistory(bool *historyRecorded = nullptr) {
+        return storeRecordWithHistory(ByteSource{ConfiguredRecord::bytes + RECORD_HEADER_BYTES, true}, CONFIGURED_PAYLOAD_CRC, historyRecorded);
+    }
+
+    /**
+     * @brief Walks the stored versions newest first.
+     *
+     *     EEPROMVersionControl::versionHistoryIterator history;
+     *     EEPROMVersionControl::versionData data;
+     *     while (history.next(data)) {
+     *         EEPROMVersionControl::printVersionData(data);
+     *     }
+     *
+     * The first call returns the current record; every further call turns `data` into the version before it.
+     * Keep passing the same versionData, since each step is applied to the previous one.
+     */
+    class versionHistoryIterator {
+    public:
+        /**
+         * @brief moves to the next older version.
+         * @return false when there are no older versions. `data` is then left in an unspecified state.
+         */
+        bool next(versionData &data) {
+            if (!started) {
+                started = true;
+                if (!getVersionData(data)) {
+                    return false;
+                }
+                crc = data.crc;
+                entry = findNewestHistoryEntry(sequence);
+                return true;
+            }
+
+            uint8_t *payload = reinterpret_cast<uint8_t *>(&data) + RECORD_HEADER_BYTES;
+            bool applied = false;
+            bool continued = true;
+            while (continued) {
+                historyEntryHeader header;
+                if (entry == NO_SLOT || remaining == 0 || !readHistoryEntry(entry, header) || header.sequence != sequence) {
+                    entry = NO_SLOT;
+                    return false;
+                }
+                const uint16_t deltaAddress = historyEntryAddress(entry) + HISTORY_ENTRY_HEADER_BYTES;
+                entry = previousHistoryEntry(entry);
+                sequence--;
+                remaining--;
+
+                if (header.newerCrc != crc) {
+                    if (applied) {
+                        entry = NO_SLOT;    // the rest of a split change is missing
+                        return false;
+                    }
+                    continue;               // made from a version that was never stored, or was replaced without history
+                }
+                if (!applyDelta(deltaAddress, (header.length & ~HISTORY_CONTINUED) - 1, payload)
+                    || crc16(payload, RECORD_PAYLOAD_BYTES) != header.olderCrc) {
+                    entry = NO_SLOT;
+                    return false;
+                }
+                crc = header.olderCrc;
+                applied = true;
+                continued = header.length & HISTORY_CONTINUED;
+            }
+            data.crc = crc;
+            stepsBack++;
+            return true;
+        }
+
+        /**
+         * @brief how many versions back the last version returned by next() is. 0 is the current record.
+         */
+        uint8_t steps() const { return stepsBack; }
+
+    private:
+        bool started = false;
+        uint8_t entry = NO_SLOT;           // next entry to apply
+        uint16_t sequence = 0;             // its expected sequence number
+        uint16_t crc = 0;                  // CRC-16 of the version currently in `data`
+        uint8_t remaining = VERSION_HISTORY_DEPTH;
+        uint8_t stepsBack = 0;
+
+        static bool applyDelta(uint16_t address, uint8_t length, uint8_t *payload) {
+            uint8_t i = 0;
+            while (i + 2 <= length) {
+                uint8_t offset = Storage::read(address + i);
+                uint8_t count = Storage::read(address + i + 1);
+                i += 2;
+                if (offset + count > RECORD_PAYLOAD_BYTES || i + count > length) {
+                    return false;
+                }
+                readBlock(address + i, payload + offset, count);
+                i += count;
+            }
+            return i == length;
+        }
+    };
+}
+
+#endif // EEPROM_VC_HISTORY_H
@@ -0,0 +1,90 @@
+/**
+ * Minimal stand-ins for the parts of the Arduino core that EEPROM_Version_Control.h uses, so the library
+ * can be compiled and exercised on a regular Linux/macOS host (benchmarks, tooling, regression checks).
+ *
+ * This file is only pulled in when ARDUINO is not defined. It is not meant to be a full Arduino emulation,
+ * just enough of PROGMEM, Print and Serial for the version control code to build unchanged.
+ */
+
+#ifndef EEPROM_VC_HOST_H
+#define EEPROM_VC_HOST_H
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// ATmega328P geometry unless the host build says otherwise (E2END is the last valid EEPROM address)
+#ifndef E2END
+#define E2END 0x3FF
+#endif
+
+// flash and RAM share one address space on the host, so PROGMEM is a no-op
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_ptr(addr) (*reinterpret_cast<void * const *>(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+/**
+ * @brief Cut down version of the Arduino Print class. Subclasses only need to implement write(uint8_t).
+ */
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t print(const char *str) { return write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+    size_t print(const __FlashStringHelper *str) { return print(reinterpret_cast<const char *>(str)); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(unsigned long value) { char buf[24]; snprintf(buf, sizeof(buf), "%lu", value); return print(buf); }
+    size_t print(long value) { char buf[24]; snprintf(buf, sizeof(buf), "%ld", value); return print(buf); }
+    size_t print(unsigned int value) { return print(static_cast<unsigned long>(value)); }
+    size_t print(int value) { return print(static_cast<long>(value)); }
+    size_t print(unsigned char value) { return print(static_cast<unsigned long>(value)); }
+
+    size_t println() { return print("\r\n"); }
+    template <typename T>
+    size_t println(T value) { size_t n = print(value); return n + println(); }
+};
+
+/**
+ * @brief Print sink that writes to stdout, standing in for HardwareSerial.
+ */
+class HostSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+};
+
+// one Serial for the whole program, like the core's: the object is a class template static member (defined in
+// every file that uses it, kept once by the linker), and Serial refers to it
+template <typename = void> struct hostSerialInstance {
+    static HostSerial serial;
+};
+template <typename T> HostSerial hostSerialInstance<T>::serial;
+
+static constexpr HostSerial &Serial = hostSerialInstance<>::serial;
+
+#endif // ARDUINO
+
+#endif // EEPROM_VC_HOST_H
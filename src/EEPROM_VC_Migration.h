@@ -0,0 +1,145 @@
+/**
+ * Reading and upgrading version data written by older versions of EEPROM_Version_Control.h.
+ *
+ * Every record stores the LIBRARY_VERSION of the code that wrote it. The current code only accepts records of
+ * its own version (slotIsValid() checks it), so after a library upgrade a device in the field reports
+ * "Version data does not exist." until the record is rewritten. This file adds a table of decoders, one per
+ * stored layout, that turn whatever is in EEPROM into the current versionData:
+ *
+ *     LIBRARY_VERSION 2   the current layout: header with length and CRC-16, optional slots, and the
+ *                         fingerprint of the values
+ *     LIBRARY_VERSION 1   the original layout: dataWritten, libraryVersion, then the fields, no CRC,
+ *                         always 60 bytes below E2END
+ *
+ * getMigratedVersionData() tries them newest first. migrateVersionData() then stores the result in the current
+ * layout. It goes through writeDataToEEPROM(), so only the bytes that differ from what is stored are written.
+ *
+ * When LIBRARY_VERSION changes, add a decoder for the layout being replaced and list it in
+ * migrationDecoderTable (and raise MIGRATION_DECODER_COUNT).
+ */
+
+#ifndef EEPROM_VC_MIGRATION_H
+#define EEPROM_VC_MIGRATION_H
+
+#include <EEPROM_Version_Control.h>
+
+namespace EEPROMVersionControl {
+
+    /**
+     * @brief The LIBRARY_VERSION 1 record, as it was stored in EEPROM. Only used for its offsets.
+     */
+    struct versionDataV1 {
+        uint16_t dataWritten;
+        uint8_t libraryVersion;
+        char projectName[21];
+        char vendor[2];
+        uint8_t projectVersion;
+        char softwareVersion[8];
+        char finalSoftwareDate[19];
+    };
+
+    // version 1 wrote to E2END - 60, regardless of later changes to the layout constants and placement options
+    constexpr uint16_t V1_RESERVED_BYTES = 60;
+    static_assert(EEPROM_SIZE_BYTES > V1_RESERVED_BYTES + 1, "version 1 record does not fit in the EEPROM");
+    constexpr uint16_t V1_RECORD_ADDRESS = EEPROM_SIZE_BYTES - 1 - V1_RESERVED_BYTES;
+    static_assert(V1_RECORD_ADDRESS + sizeof(versionDataV1) <= EEPROM_SIZE_BYTES, "version 1 record does not fit in the EEPROM");
+
+    /**
+     * @brief reads a string field of the version 1 record. The record had no CRC, so a field that isn't
+     * null terminated is taken as a sign that the bytes aren't a record.
+     */
+    inline bool readV1StringField(uint16_t fieldOffset, char *dest, size_t fieldSize) {
+        readBlock(V1_RECORD_ADDRESS + fieldOffset, dest, fieldSize);
+        return dest[fieldSize - 1] == '\0';
+    }
+
+    /**
+     * @brief decodes a LIBRARY_VERSION 1 record into the current versionData.
+     * @return `false` if no version 1 record is stored (storedData may be partially overwritten).
+     */
+    inline bool decodeVersionDataV1(versionData &storedData) {
+        if (Storage::read(V1_RECORD_ADDRESS + offsetof(versionDataV1, dataWritten)) != DATA_EXISTS_MAGIC_NUMBER
+            || Storage::read(V1_RECORD_ADDRESS + offsetof(versionDataV1, dataWritten) + 1) != 0
+            || Storage::read(V1_RECORD_ADDRESS + offsetof(versionDataV1, libraryVersion)) != 1) {
+            return false;
+        }
+        if (!readV1StringField(offsetof(versionDataV1, projectName), storedData.projectName, sizeof(storedData.projectName))
+            || !readV1StringField(offsetof(versionDataV1, vendor), storedData.vendor, sizeof(storedData.vendor))
+            || !readV1StringField(offsetof(versionDataV1, softwareVersion), storedData.softwareVersion, sizeof(storedData.softwareVersion))
+            || !readV1StringField(offsetof(versionDataV1, finalSoftwareDate), storedData.finalSoftwareDate, sizeof(storedData.finalSoftwareDate))) {
+            return false;
+        }
+        storedData.projectVersion = Storage::read(V1_RECORD_ADDRESS + offsetof(versionDataV1, projectVersion));
+        updateFingerprint(storedData);
+
+        storedData.dataWritten = DATA_EXISTS_MAGIC_NUMBER;
+        storedData.libraryVersion = 1;
+        storedData.recordLength = RECORD_PAYLOAD_BYTES;
+        storedData.crc = crc16(reinterpret_cast<const uint8_t *>(&storedData) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES);
+        return true;
+    }
+
+    /**
+     * @brief One row of the migration table: the stored layout a decoder understands.
+     */
+    struct migrationDecoder {
+        uint8_t libraryVersion;
+        bool (*decode)(versionData &storedData);
+    };
+
+    constexpr uint8_t MIGRATION_DECODER_COUNT = 2;
+
+    // newest layout first, so a current record always wins over a leftover older one. A class template static
+    // member, so the table is in flash once however many files include this header.
+    template <typename = void> struct migrationDecoderTable {
+        static const migrationDecoder decoders[MIGRATION_DECODER_COUNT];
+    };
+    template <typename T> const migrationDecoder migrationDecoderTable<T>::decoders[MIGRATION_DECODER_COUNT] PROGMEM = {
+        {LIBRARY_VERSION, getVersionData},
+        {1, decodeVersionDataV1},
+    };
+    typedef migrationDecoderTable<> MigrationDecoders;
+
+    /**
+     * @brief Retrieves version data written by this or any older library version.
+     *
+     * storedData.libraryVersion is set to the version that wrote the record, so getLibraryVersion() and
+     * printLibraryVersion() report where the data came from. The other fields are in the current layout.
+     *
+     * @param storedData Reference to a `versionData` object where the retrieved data will be stored.
+     * @return the library version that wrote the record, or 0 if no readable record exists.
+     */
+    inline uint8_t getMigratedVersionData(versionData &storedData) {
+        for (uint8_t i = 0; i < MIGRATION_DECODER_COUNT; i++) {
+            bool (*decode)(versionData &) = reinterpret_cast<bool (*)(versionData &)>(pgm_read_ptr(&MigrationDecoders::decoders[i].decode));
+            if (decode(storedData)) {
+                return pgm_read_byte(&MigrationDecoders::decoders[i].libraryVersion);
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Rewrites a record from an older library version in the current layout.
+     *
+     * Does nothing if the stored record is already current or no record exists. The old record is decoded
+     * into RAM first and then written with writeDataToEEPROM(), which only writes the bytes that differ.
+     * With a single slot the new record overlaps the old one, so a reset during the rewrite loses the data,
+     * just like an interrupted single slot update; write the configured data again if that happens.
+     *
+     * @param fromVersion if not null, set to the library version that wrote the stored record (0 if none).
+     * @return the number of bytes written and the estimated EEPROM write time. Both are 0 if nothing changed.
+     */
+    inline WriteResult migrateVersionData(uint8_t *fromVersion = nullptr) {
+        versionData data;
+        uint8_t version = getMigratedVersionData(data);
+        if (fromVersion) *fromVersion = version;
+        if (version == 0 || version == LIBRARY_VERSION) {
+            return WriteResult{0, 0, false};
+        }
+        data.libraryVersion = LIBRARY_VERSION;
+        return writeDataToEEPROM(data, true);
+    }
+}
+
+#endif // EEPROM_VC_MIGRATION_H
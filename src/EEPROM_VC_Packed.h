@@ -0,0 +1,370 @@
+/**
+ * Optional packed record format for EEPROM_Version_Control.h.
+ *
+ * Most of a versionData record is padding: every string takes its maximum size. The packed format stores the
+ * same fields in their semantic form, which typically takes less than half the bytes, and every byte saved is
+ * ~3.3 ms less write time and one less cell worn:
+ *  - projectName and vendor: a length byte plus 6 bits per character (letters, digits, space and '-')
+ *  - projectVersion: one byte
+ *  - softwareVersion: a component count plus one byte per numeric component ("1.0.0.0" -> 5 bytes)
+ *  - finalSoftwareDate: days since January 1, 2000 in two bytes ("January 15, 2025" -> 2 bytes)
+ *
+ * Packed records are decoded back into a versionData on read (getPackedVersionData()), and packVersionData() only
+ * accepts values that decode back to exactly the same text. Values that don't (other characters, a software
+ * version with leading zeros or an empty component such as "01.2" or "1.2.", a date not written as
+ * "Month D, YYYY" with the full month name and no leading zeros) are rejected, and the fixed versionData format
+ * should be used instead.
+ *
+ * Packed records use the same header, CRC, slots and commit protocol as versionData records, with their own
+ * magic number. The slots hold one format at a time (see planRecord()).
+ */
+
+#ifndef EEPROM_VC_PACKED_H
+#define EEPROM_VC_PACKED_H
+
+#include <EEPROM_Version_Control.h>
+
+namespace EEPROMVersionControl {
+
+    constexpr uint16_t PACKED_MAGIC_NUMBER = 44;        // marks a packed record (versionData records use DATA_EXISTS_MAGIC_NUMBER)
+    constexpr uint16_t PACKED_DATE_EPOCH_YEAR = 2000;   // day 0 of the packed date
+    constexpr uint8_t PACKED_VERSION_COMPONENTS = 4;    // softwareVersion holds up to 4 numbers, e.g. 1.0.0.0
+
+    // worst case: both strings at full length, 4 version components, date
+    constexpr uint8_t PACKED_MAX_BYTES = (1 + (6 * (sizeof(versionData::projectName) - 1) + 7) / 8)
+                                       + (1 + (6 * (sizeof(versionData::vendor) - 1) + 7) / 8)
+                                       + 1
+                                       + (1 + PACKED_VERSION_COMPONENTS)
+                                       + 2;
+    static_assert(PACKED_MAX_BYTES <= MAX_PAYLOAD_BYTES, "packed record does not fit in a slot");
+
+    // a class template static member, so the names are in flash once however many files include this header
+    template <typename = void> struct packedMonthNames {
+        static const char names[12][10];
+    };
+    template <typename T> const char packedMonthNames<T>::names[12][10] PROGMEM = {
+        "January", "February", "March", "April", "May", "June",
+        "July", "August", "September", "October", "November", "December"
+    };
+    typedef packedMonthNames<> PackedMonthNames;
+
+    /**
+     * @brief 6 bit code of a character: 0 = space, 1-26 = A-Z, 27-52 = a-z, 53-62 = 0-9, 63 = '-'.
+     * @return the code, or -1 if the character can't be packed.
+     */
+    inline int8_t sixBitCode(char c) {
+        if (c == ' ') return 0;
+        if (c >= 'A' && c <= 'Z') return 1 + (c - 'A');
+        if (c >= 'a' && c <= 'z') return 27 + (c - 'a');
+        if (c >= '0' && c <= '9') return 53 + (c - '0');
+        if (c == '-') return 63;
+        return -1;
+    }
+
+    inline char sixBitChar(uint8_t code) {
+        if (code == 0) return ' ';
+        if (code <= 26) return 'A' + (code - 1);
+        if (code <= 52) return 'a' + (code - 27);
+        if (code <= 62) return '0' + (code - 53);
+        return '-';
+    }
+
+    /**
+     * @brief days since January 1, PACKED_DATE_EPOCH_YEAR of a calendar date (month and day 1 based).
+     */
+    inline int32_t daysFromCivil(int32_t year, uint8_t month, uint8_t day) {
+        // http://howardhinnant.github.io/date_algorithms.html#days_from_civil, shifted to our epoch
+        year -= month <= 2;
+        const int32_t era = (year >= 0 ? year : year - 399) / 400;
+        const int32_t yearOfEra = year - era * 400;
+        const int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 730425;        // 730425 = days from 0000-03-01 to 2000-01-01
+    }
+
+    inline void civilFromDays(int32_t days, int32_t &year, uint8_t &month, uint8_t &day) {
+        days += 730425;
+        const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const int32_t dayOfEra = days - era * 146097;
+        const int32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int32_t monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = yearOfEra + era * 400 + (month <= 2);
+    }
+
+    /**
+     * @brief parses a date written exactly as formatPackedDate() writes it, e.g. "January 15, 2025": the full,
+     * case sensitive month name and a day without leading zeros.
+     * @return false if the text is not such a date between 2000 and 2179.
+     */
+    inline bool parsePackedDate(const char *text, uint16_t &days) {
+        size_t nameLength = 0;
+        while ((text[nameLength] >= 'A' && text[nameLength] <= 'Z') || (text[nameLength] >= 'a' && text[nameLength] <= 'z')) nameLength++;
+        uint8_t month = 0;
+        for (uint8_t m = 0; m < 12; m++) {
+            if (nameLength == strlen_P(PackedMonthNames::names[m]) && strncmp_P(text, PackedMonthNames::names[m], nameLength) == 0) {
+                month = m + 1;
+                break;
+            }
+        }
+        if (month == 0) return false;
+
+        const char *cursor = text + nameLength;
+        if (*cursor++ != ' ' || *cursor == '0') return false;
+        uint16_t day = 0;
+        uint8_t dayDigits = 0;
+        while (*cursor >= '0' && *cursor <= '9' && dayDigits < 3) { day = day * 10 + (*cursor++ - '0'); dayDigits++; }
+        if (*cursor++ != ',' || *cursor++ != ' ') return false;
+        int32_t year = 0;
+        uint8_t yearDigits = 0;
+        while (*cursor >= '0' && *cursor <= '9' && yearDigits < 5) { year = year * 10 + (*cursor++ - '0'); yearDigits++; }
+        if (*cursor != '\0' || yearDigits != 4 || day < 1 || day > 31) return false;
+
+        int32_t parsed = daysFromCivil(year, month, day);
+        int32_t checkYear;
+        uint8_t checkMonth, checkDay;
+        civilFromDays(parsed, checkYear, checkMonth, checkDay);
+        if (parsed < 0 || parsed > 0xFFFF || checkMonth != month || checkDay != day) return false;    // e.g. February 30
+        days = static_cast<uint16_t>(parsed);
+        return true;
+    }
+
+    /**
+     * @brief appends the decimal form of value at cursor, stopping one byte short of end. Avoids pulling in printf.
+     */
+    inline void appendDecimal(char *&cursor, char *end, uint32_t value) {
+        char digits[10];
+        uint8_t count = 0;
+        do {
+            digits[count++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        while (count > 0 && cursor + 1 < end) *cursor++ = digits[--count];
+        *cursor = '\0';
+    }
+
+    /**
+     * @brief formats a packed date as "Month D, YYYY".
+     */
+    inline void formatPackedDate(uint16_t days, char *buffer, size_t bufferSize) {
+        int32_t year;
+        uint8_t month, day;
+        civilFromDays(days, year, month, day);
+        char *cursor = buffer;
+        char *const end = buffer + bufferSize;
+        for (const char *name = PackedMonthNames::names[month - 1]; pgm_read_byte(name) != '\0' && cursor + 1 < end; name++) {
+            *cursor++ = pgm_read_byte(name);
+        }
+        if (cursor + 1 < end) *cursor++ = ' ';
+        appendDecimal(cursor, end, day);
+        if (cursor + 1 < end) *cursor++ = ',';
+        if (cursor + 1 < end) *cursor++ = ' ';
+        appendDecimal(cursor, end, year);
+    }
+
+    /**
+     * @brief Sequential writer for the packed payload, with a bit accumulator for the 6 bit text.
+     */
+    class packedWriter {
+    public:
+        packedWriter(uint8_t *buffer, uint8_t capacity) : out(buffer), capacity(capacity), used(0), failed(false) {}
+
+        void putByte(uint8_t value) {
+            if (used >= capacity) { failed = true; return; }
+            out[used++] = value;
+        }
+
+        void putText(const char *text, size_t maxLength) {
+            size_t length = strnlen(text, maxLength);
+            putByte(static_cast<uint8_t>(length));
+            uint16_t bits = 0;
+            uint8_t bitCount = 0;
+            for (size_t i = 0; i < length; i++) {
+                int8_t code = sixBitCode(text[i]);
+                if (code < 0) { failed = true; return; }
+                bits = (bits << 6) | code;
+                bitCount += 6;
+                if (bitCount >= 8) {
+                    bitCount -= 8;
+                    putByte(bits >> bitCount);
+                }
+            }
+            if (bitCount > 0) putByte(bits << (8 - bitCount));
+        }
+
+        uint8_t length() const { return used; }
+        bool ok() const { return !failed; }
+
+    private:
+        uint8_t *out;
+        uint8_t capacity;
+        uint8_t used;
+        bool failed;
+    };
+
+    /**
+     * @brief Sequential reader for a packed payload stored in EEPROM.
+     */
+    class packedReader {
+    public:
+        packedReader(uint16_t address, uint8_t length) : position(address), end(address + length), failed(false) {}
+
+        uint8_t getByte() {
+            if (position >= end) { failed = true; return 0; }
+            return Storage::read(position++);
+        }
+
+        void getText(char *buffer, size_t bufferSize) {
+            uint8_t length = getByte();
+            if (length >= bufferSize) { failed = true; length = 0; }
+            uint16_t bits = 0;
+            uint8_t bitCount = 0;
+            for (uint8_t i = 0; i < length; i++) {
+                if (bitCount < 6) {
+                    bits = (bits << 8) | getByte();
+                    bitCount += 8;
+                }
+                bitCount -= 6;
+                buffer[i] = sixBitChar((bits >> bitCount) & 0x3F);
+            }
+            buffer[length] = '\0';
+        }
+
+        bool ok() const { return !failed; }
+
+    private:
+        uint16_t position;
+        uint16_t end;
+        bool failed;
+    };
+
+    /**
+     * @brief A packed payload in RAM, ready to be written with writePackedDataToEEPROM().
+     */
+    struct packedRecord {
+        uint8_t bytes[PACKED_MAX_BYTES];
+        uint8_t length;
+    };
+
+    /**
+     * @brief encodes dataBlock into the packed format.
+     * @return false if a field can't be packed (see the top of this file); record is then unusable.
+     */
+    inline bool packVersionData(const versionData &dataBlock, packedRecord &record) {
+        packedWriter writer(record.bytes, sizeof(record.bytes));
+        writer.putText(dataBlock.projectName, sizeof(dataBlock.projectName) - 1);
+        writer.putText(dataBlock.vendor, sizeof(dataBlock.vendor) - 1);
+        writer.putByte(dataBlock.projectVersion);
+
+        uint8_t components[PACKED_VERSION_COMPONENTS];
+        uint8_t count = 0;
+        const char *cursor = dataBlock.softwareVersion;
+        while (count < PACKED_VERSION_COMPONENTS) {
+            if (*cursor < '0' || *cursor > '9' || (cursor[0] == '0' && cursor[1] >= '0' && cursor[1] <= '9')) {
+                return false;       // empty component ("1..2", "1.2.") or leading zero ("01.2"), which wouldn't read back
+            }
+            uint16_t value = 0;
+            while (*cursor >= '0' && *cursor <= '9' && value <= 0xFF) value = value * 10 + (*cursor++ - '0');
+            if (value > 0xFF) return false;
+            components[count++] = static_cast<uint8_t>(value);
+            if (*cursor != '.') break;
+            cursor++;
+        }
+        if (*cursor != '\0') return false;
+        writer.putByte(count);
+        for (uint8_t i = 0; i < count; i++) writer.putByte(components[i]);
+
+        uint16_t days;
+        if (!parsePackedDate(dataBlock.finalSoftwareDate, days)) return false;
+        writer.putByte(days & 0xFF);
+        writer.putByte(days >> 8);
+
+        record.length = writer.length();
+        return writer.ok();
+    }
+
+    /**
+     * @brief Writes version data to EEPROM in the packed format.
+     *
+     * Works like writeDataToEEPROM(): nothing is written if a record of any format already exists and `overwrite`
+     * is false, or if the newest record is this packed record, and otherwise only the bytes that differ are written.
+     *
+     * @param dataBlock the data to store.
+     * @param overwrite Set to `true` to overwrite previously written data (default: `false`).
+     * @param result if not null, set to the number of bytes written and the estimated write time.
+     * @return false if dataBlock can't be packed (nothing is written).
+     */
+    inline bool writePackedDataToEEPROM(const versionData &dataBlock, bool overwrite = false, WriteResult *result = nullptr) {
+        packedRecord record;
+        if (!packVersionData(dataBlock, record)) {
+            return false;
+        }
+        WriteResult written = storeRecord(ByteSource{record.bytes, false}, record.length, crc16(record.bytes, record.length),
+                                          overwrite, PACKED_MAGIC_NUMBER);
+        if (result) *result = written;
+        return true;
+    }
+
+    /**
+     * @brief true if a valid packed record (magic number, library version, length and CRC) is stored.
+     */
+    inline bool validatePackedData() {
+        uint16_t sequence = 0;
+        return findNewestSlot(sequence, PACKED_MAGIC_NUMBER) != NO_SLOT;
+    }
+
+    /**
+     * @brief Reads and decodes the newest packed record into storedData.
+     *
+     * The header fields of storedData are filled in as for a versionData record, so printVersionData() and
+     * getLibraryVersion() work on the result.
+     *
+     * @return `true` if data was successfully retrieved, `false` if no valid packed data exists or it doesn't
+     *         decode (storedData untouched).
+     */
+    inline bool getPackedVersionData(versionData &storedData) {
+        uint16_t sequence = 0;
+        uint8_t slot = findNewestSlot(sequence, PACKED_MAGIC_NUMBER);
+        if (slot == NO_SLOT) {
+            return false;
+        }
+        versionData decoded;
+        memset(decoded.projectName, 0, sizeof(decoded.projectName));
+        memset(decoded.vendor, 0, sizeof(decoded.vendor));
+        memset(decoded.softwareVersion, 0, sizeof(decoded.softwareVersion));
+        memset(decoded.finalSoftwareDate, 0, sizeof(decoded.finalSoftwareDate));
+        packedReader reader(recordAddress(slot) + RECORD_HEADER_BYTES,
+                            Storage::read(recordAddress(slot) + offsetof(recordHeader, recordLength)));
+        reader.getText(decoded.projectName, sizeof(decoded.projectName));
+        reader.getText(decoded.vendor, sizeof(decoded.vendor));
+        decoded.projectVersion = reader.getByte();
+
+        uint8_t count = reader.getByte();
+        if (count == 0 || count > PACKED_VERSION_COMPONENTS) {
+            return false;
+        }
+        char *cursor = decoded.softwareVersion;
+        char *const end = decoded.softwareVersion + sizeof(decoded.softwareVersion);
+        for (uint8_t i = 0; i < count; i++) {
+            if (i > 0 && cursor + 1 < end) *cursor++ = '.';
+            appendDecimal(cursor, end, reader.getByte());
+        }
+
+        uint16_t days = reader.getByte();
+        days |= static_cast<uint16_t>(reader.getByte()) << 8;
+        formatPackedDate(days, decoded.finalSoftwareDate, sizeof(decoded.finalSoftwareDate));
+        if (!reader.ok()) {
+            return false;
+        }
+
+        updateFingerprint(decoded);
+        decoded.recordLength = RECORD_PAYLOAD_BYTES;
+        decoded.crc = crc16(reinterpret_cast<const uint8_t *>(&decoded) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES);
+        storedData = decoded;
+        return true;
+    }
+}
+
+#endif // EEPROM_VC_PACKED_H
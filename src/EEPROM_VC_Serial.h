@@ -0,0 +1,164 @@
+/**
+ * Binary version query for EEPROM_Version_Control.h, for testers that read the version data over a serial port.
+ *
+ * printVersionData() prints labelled text, which a tester has to parse. Here the tester sends a single request
+ * byte and the unit answers with one frame holding the stored record exactly as it is in EEPROM:
+ *
+ *     request   VERSION_QUERY_REQUEST
+ *     reply     VERSION_REPLY_SYNC, status, length, record (length bytes), frame CRC (low byte, high byte)
+ *
+ * status is VERSION_REPLY_RECORD with the newest valid record (length RECORD_BYTES: the recordHeader with the
+ * payload CRC, then the payload), or VERSION_REPLY_NO_RECORD with length 0. The frame CRC is the CRC-16 the
+ * records use, over status, length and the record. Multi-byte values are little endian, as stored. A reply is
+ * RECORD_BYTES + 5 = 66 bytes, about 5.7 ms at 115200 baud. The record is streamed from EEPROM, so answering
+ * takes no RAM buffer.
+ *
+ * In the sketch, pass received bytes to handleVersionQuery(), or let serviceVersionQuery() read the port if
+ * nothing else uses its input:
+ *
+ *     void loop() {
+ *         EEPROMVersionControl::serviceVersionQuery(Serial);
+ *     }
+ *
+ * versionReplyParser decodes replies on the tester side. The Linux client is extras/tools/serial_query.cpp.
+ */
+
+#ifndef EEPROM_VC_SERIAL_H
+#define EEPROM_VC_SERIAL_H
+
+#include <EEPROM_Version_Control.h>
+
+namespace EEPROMVersionControl {
+
+    constexpr uint8_t VERSION_QUERY_REQUEST = 0xA5;
+    constexpr uint8_t VERSION_REPLY_SYNC = 0xA6;        // not ASCII, so printed text rarely contains it
+    constexpr uint8_t VERSION_REPLY_RECORD = 0x00;
+    constexpr uint8_t VERSION_REPLY_NO_RECORD = 0x01;
+    constexpr uint8_t VERSION_REPLY_OVERHEAD_BYTES = 5;     // sync, status, length, CRC
+
+    /**
+     * @brief sends a reply frame with the newest valid record (or none) to `out`.
+     */
+    inline void writeVersionReply(Print &out) {
+        const uint8_t newest = findNewestSlot();
+        const uint8_t status = (newest == NO_SLOT) ? VERSION_REPLY_NO_RECORD : VERSION_REPLY_RECORD;
+        const uint8_t length = (newest == NO_SLOT) ? 0 : RECORD_BYTES;
+        out.write(VERSION_REPLY_SYNC);
+        out.write(status);
+        out.write(length);
+        uint16_t crc = crc16Update(crc16Update(CRC16_INITIAL_VALUE, status), length);
+        for (uint8_t i = 0; i < length; i++) {
+            const uint8_t value = Storage::read(recordAddress(newest) + i);
+            out.write(value);
+            crc = crc16Update(crc, value);
+        }
+        out.write(static_cast<uint8_t>(crc & 0xFF));
+        out.write(static_cast<uint8_t>(crc >> 8));
+    }
+
+    /**
+     * @brief answers the query if `received` is the request byte.
+     * @return true if it was, and the reply has been sent.
+     */
+    inline bool handleVersionQuery(uint8_t received, Print &out) {
+        if (received != VERSION_QUERY_REQUEST) return false;
+        writeVersionReply(out);
+        return true;
+    }
+
+    /**
+     * @brief reads at most one byte from `port` (a Stream, e.g. Serial) and answers it if it is the request.
+     * Other bytes are dropped, so only use this if the sketch doesn't read the port itself.
+     */
+    template <typename Port>
+    bool serviceVersionQuery(Port &port) {
+        return port.available() > 0 && handleVersionQuery(static_cast<uint8_t>(port.read()), port);
+    }
+
+    /**
+     * @brief Decodes reply frames a byte at a time, on the tester's side. Bytes before the sync byte (e.g. text
+     * the sketch printed) are skipped. A record is only accepted if the frame CRC and the record itself (magic
+     * number, library version, length, payload CRC) are valid.
+     */
+    class versionReplyParser {
+    public:
+        enum state : uint8_t {
+            WAITING,            // for the sync byte
+            RECEIVING,
+            RECORD_RECEIVED,    // record() holds the unit's version data
+            NO_RECORD_RECEIVED, // the unit has no valid version data
+            FRAME_ERROR,        // bad status, length or frame CRC
+            RECORD_ERROR,       // the frame is fine, but the record in it isn't valid
+        };
+
+        versionReplyParser() : current(WAITING), position(0) {}
+
+        /**
+         * @brief feeds the next received byte. After a final state, the next byte starts looking for a new frame.
+         * @return WAITING or RECEIVING while the frame isn't complete, then one of the other states.
+         */
+        state feed(uint8_t value) {
+            if (current != RECEIVING) {
+                current = (value == VERSION_REPLY_SYNC) ? RECEIVING : WAITING;
+                position = 0;
+                crc = CRC16_INITIAL_VALUE;
+                return current;
+            }
+            if (position == 0 && value == VERSION_REPLY_SYNC) {
+                return current;     // a stray sync byte just before the real one
+            }
+            if (position == 0) {
+                status = value;
+                crc = crc16Update(crc, value);
+            } else if (position == 1) {
+                length = value;
+                crc = crc16Update(crc, value);
+                if (!(status == VERSION_REPLY_RECORD && length == RECORD_BYTES)
+                    && !(status == VERSION_REPLY_NO_RECORD && length == 0)) {
+                    return current = FRAME_ERROR;
+                }
+            } else if (position < 2u + length) {
+                bytes[position - 2] = value;
+                crc = crc16Update(crc, value);
+            } else if (position == 2u + length) {
+                receivedCrc = value;
+            } else {
+                receivedCrc |= static_cast<uint16_t>(value) << 8;
+                return current = finish();
+            }
+            position++;
+            return current;
+        }
+
+        /**
+         * @brief the received version data, after RECORD_RECEIVED.
+         */
+        void record(versionData &data) const {
+            memcpy(reinterpret_cast<uint8_t *>(&data), bytes, RECORD_BYTES);
+        }
+
+    private:
+        state current;
+        uint8_t position;           // bytes received after the sync byte
+        uint8_t status;
+        uint8_t length;
+        uint16_t crc;
+        uint16_t receivedCrc;
+        uint8_t bytes[RECORD_BYTES];
+
+        state finish() {
+            if (crc != receivedCrc) return FRAME_ERROR;
+            if (status == VERSION_REPLY_NO_RECORD) return NO_RECORD_RECEIVED;
+            recordHeader header;
+            memcpy(&header, bytes, sizeof(header));
+            if (header.dataWritten != DATA_EXISTS_MAGIC_NUMBER || header.libraryVersion != LIBRARY_VERSION
+                || header.recordLength != RECORD_PAYLOAD_BYTES
+                || crc16(bytes + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) != header.crc) {
+                return RECORD_ERROR;
+            }
+            return RECORD_RECEIVED;
+        }
+    };
+}
+
+#endif // EEPROM_VC_SERIAL_H
@@ -0,0 +1,266 @@
+/**
+ * Optional type-length-value (TLV) record format for EEPROM_Version_Control.h.
+ *
+ * The versionData record pads every string to its maximum size and has a fixed set of fields, so adding one
+ * means changing LIBRARY_VERSION. A TLV record stores only the fields that are set, each as
+ *
+ *     [tag: 1 byte][length: 1 byte][value: length bytes]
+ *
+ * so short values and unused fields cost nothing and new fields can be added to the schema without touching
+ * the record layout. TLV records use the same header, CRC, wear leveling slots and commit protocol as
+ * versionData records, but their own magic number. The slots hold one format at a time: writing a TLV record
+ * over a versionData record (or the other way round) needs `overwrite` and retires the old format once the new
+ * record is committed.
+ *
+ * The schema is declared once, in EEPROM_VC_TLV_SCHEMA below. To add fields of your own, define
+ * EEPROM_VC_TLV_USER_FIELDS before including this file, using tags from 128 up:
+ *
+ *     #define EEPROM_VC_TLV_USER_FIELDS(FIELD) \
+ *         FIELD(BOARD_REVISION, 128, 4)
+ *     #include <EEPROM_VC_TLV.h>
+ *
+ * Reusing a tag is a compile error.
+ */
+
+#ifndef EEPROM_VC_TLV_H
+#define EEPROM_VC_TLV_H
+
+#include <EEPROM_Version_Control.h>
+
+// FIELD(name, tag, maximum length in bytes)
+#define EEPROM_VC_TLV_SCHEMA(FIELD)         \
+    FIELD(PROJECT_NAME,      1, 20)         \
+    FIELD(VENDOR,            2, 1)          \
+    FIELD(PROJECT_VERSION,   3, 1)          \
+    FIELD(SOFTWARE_VERSION,  4, 7)          \
+    FIELD(SOFTWARE_DATE,     5, 18)         \
+    FIELD(SERIAL_NUMBER,     6, 16)         \
+    FIELD(BUILD_ID,          7, 20)         \
+    FIELD(FINGERPRINT,       8, 4)          \
+    EEPROM_VC_TLV_USER_FIELDS(FIELD)
+
+#ifndef EEPROM_VC_TLV_USER_FIELDS
+#define EEPROM_VC_TLV_USER_FIELDS(FIELD)
+#endif
+
+namespace EEPROMVersionControl {
+
+    constexpr uint16_t TLV_MAGIC_NUMBER = 43;       // marks a TLV record (versionData records use DATA_EXISTS_MAGIC_NUMBER)
+    constexpr uint8_t TLV_FIELD_HEADER_BYTES = 2;   // tag + length
+
+    // TLV_PROJECT_NAME, TLV_VENDOR, ...
+    enum tlvTag : uint8_t {
+#define EEPROM_VC_TLV_ENUM(name, tag, maxLength) TLV_##name = tag,
+        EEPROM_VC_TLV_SCHEMA(EEPROM_VC_TLV_ENUM)
+#undef EEPROM_VC_TLV_ENUM
+    };
+
+    /**
+     * @brief compile-time schema lookup: tlvField<TLV_VENDOR>::maxLength. Only declared tags have a definition.
+     */
+    template <uint8_t Tag> struct tlvField;
+#define EEPROM_VC_TLV_TRAITS(name, tag, length)                                                             \
+    template <> struct tlvField<tag> {                                                                      \
+        static constexpr uint8_t maxLength = length;                                                        \
+    };                                                                                                      \
+    static_assert(length + TLV_FIELD_HEADER_BYTES <= MAX_PAYLOAD_BYTES, "TLV field " #name " can never fit in a slot");
+    EEPROM_VC_TLV_SCHEMA(EEPROM_VC_TLV_TRAITS)
+#undef EEPROM_VC_TLV_TRAITS
+
+    /**
+     * @brief run-time schema lookup.
+     * @return the maximum length of the field with this tag, or 0 if the tag is not in the schema.
+     */
+    inline uint8_t tlvMaxLength(uint8_t tag) {
+        switch (tag) {
+#define EEPROM_VC_TLV_CASE(name, tag, maxLength) case tag: return maxLength;
+            EEPROM_VC_TLV_SCHEMA(EEPROM_VC_TLV_CASE)
+#undef EEPROM_VC_TLV_CASE
+            default: return 0;
+        }
+    }
+
+    /**
+     * @brief Assembles a TLV payload in RAM before it is written with writeTLVRecord().
+     * 
+     * Holds at most MAX_PAYLOAD_BYTES. Each tag can be added once; the add functions return false if the tag is
+     * unknown or already present, the value is longer than the schema allows, or the record is full.
+     */
+    class tlvRecordBuilder {
+    public:
+        tlvRecordBuilder() : used(0) {}
+
+        bool add(uint8_t tag, const void *value, uint8_t length) {
+            if (tlvMaxLength(tag) == 0 || length > tlvMaxLength(tag) || has(tag) || used + TLV_FIELD_HEADER_BYTES + length > MAX_PAYLOAD_BYTES) {
+                return false;
+            }
+            buffer[used++] = tag;
+            buffer[used++] = length;
+            memcpy(buffer + used, value, length);
+            used += length;
+            return true;
+        }
+
+        /**
+         * @brief adds a string field. The null terminator is not stored.
+         */
+        bool addString(uint8_t tag, const char *value) {
+            size_t length = strlen(value);
+            return length <= 0xFF && add(tag, value, static_cast<uint8_t>(length));
+        }
+
+        /**
+         * @brief adds a string field whose length is checked against the schema at compile time.
+         * e.g. builder.addString<TLV_SOFTWARE_VERSION>("1.2.0");
+         */
+        template <uint8_t Tag, size_t N>
+        bool addString(const char (&value)[N]) {
+            static_assert(N - 1 <= tlvField<Tag>::maxLength, "Error in addString: value exceeds the maximum length of this TLV field.");
+            return addString(Tag, static_cast<const char *>(value));
+        }
+
+        bool addByte(uint8_t tag, uint8_t value) {
+            return add(tag, &value, 1);
+        }
+
+        bool has(uint8_t tag) const {
+            for (uint8_t i = 0; i < used; i += TLV_FIELD_HEADER_BYTES + buffer[i + 1]) {
+                if (buffer[i] == tag) return true;
+            }
+            return false;
+        }
+
+        const uint8_t *data() const { return buffer; }
+        uint8_t length() const { return used; }
+
+    private:
+        uint8_t buffer[MAX_PAYLOAD_BYTES];
+        uint8_t used;
+    };
+
+    /**
+     * @brief payload bytes of configuredTLVRecord(): every string at its configured length, the project version, the
+     * fingerprint, and the build id if one is set.
+     */
+    constexpr uint16_t CONFIGURED_TLV_PAYLOAD_BYTES =
+        (sizeof(PROJECT_NAME) - 1 + TLV_FIELD_HEADER_BYTES) + (sizeof(VENDOR) - 1 + TLV_FIELD_HEADER_BYTES)
+        + (1 + TLV_FIELD_HEADER_BYTES) + (sizeof(SOFTWARE_VERSION) - 1 + TLV_FIELD_HEADER_BYTES)
+        + (sizeof(SOFTWARE_DATE) - 1 + TLV_FIELD_HEADER_BYTES) + (sizeof(uint32_t) + TLV_FIELD_HEADER_BYTES)
+        + ((sizeof(SOFTWARE_BUILD_ID) > 1) ? sizeof(SOFTWARE_BUILD_ID) - 1 + TLV_FIELD_HEADER_BYTES : 0);
+    static_assert(CONFIGURED_TLV_PAYLOAD_BYTES <= MAX_PAYLOAD_BYTES,
+                  "the values in CL_Version_Data.conf, SOFTWARE_BUILD_ID included, don't fit in a TLV record: raise "
+                  "VERSION_DATA_RESERVED_BYTES (single slot) or shorten SOFTWARE_BUILD_ID");
+
+    /**
+     * @brief a TLV record holding the values from CL_Version_Data.conf, their CONFIGURED_FINGERPRINT and
+     * SOFTWARE_BUILD_ID, if one is set. The static_assert on CONFIGURED_TLV_PAYLOAD_BYTES makes sure they all fit.
+     */
+    inline tlvRecordBuilder configuredTLVRecord() {
+        tlvRecordBuilder record;
+        const uint32_t fingerprint = CONFIGURED_FINGERPRINT;
+        record.addString<TLV_PROJECT_NAME>(PROJECT_NAME);
+        record.addString<TLV_VENDOR>(VENDOR);
+        record.addByte(TLV_PROJECT_VERSION, PROJECT_VERSION);
+        record.addString<TLV_SOFTWARE_VERSION>(SOFTWARE_VERSION);
+        record.addString<TLV_SOFTWARE_DATE>(SOFTWARE_DATE);
+        record.add(TLV_FINGERPRINT, &fingerprint, sizeof(fingerprint));
+        if (sizeof(SOFTWARE_BUILD_ID) > 1) record.addString<TLV_BUILD_ID>(SOFTWARE_BUILD_ID);
+        return record;
+    }
+
+    /**
+     * @brief Writes a TLV record to EEPROM.
+     * 
+     * Works like writeDataToEEPROM(): nothing is written if a record of any format already exists and `overwrite`
+     * is false, or if the newest record is this TLV record. Otherwise only the bytes that differ are written, and a
+     * versionData record stored before is retired once the TLV record is committed.
+     */
+    inline WriteResult writeTLVRecord(const tlvRecordBuilder &record, bool overwrite = false) {
+        return storeRecord(ByteSource{record.data(), false}, record.length(), crc16(record.data(), record.length()),
+                           overwrite, TLV_MAGIC_NUMBER);
+    }
+
+    /**
+     * @brief true if a valid TLV record (magic number, library version, length and CRC) is stored.
+     */
+    inline bool validateTLVRecord() {
+        uint16_t sequence = 0;
+        return findNewestSlot(sequence, TLV_MAGIC_NUMBER) != NO_SLOT;
+    }
+
+    /**
+     * @brief locates a field in the newest TLV record, walking the fields in EEPROM (O(fields), no RAM copy).
+     * 
+     * @param tag the field to look for.
+     * @param address set to the EEPROM address of the field's value.
+     * @param length set to the length of the value.
+     * @return false if there is no valid TLV record or it doesn't contain the field.
+     */
+    inline bool findTLVField(uint8_t tag, uint16_t &address, uint8_t &length) {
+        uint16_t sequence = 0;
+        uint8_t slot = findNewestSlot(sequence, TLV_MAGIC_NUMBER);
+        if (slot == NO_SLOT) {
+            return false;
+        }
+        uint16_t position = recordAddress(slot) + RECORD_HEADER_BYTES;
+        const uint16_t end = position + Storage::read(recordAddress(slot) + offsetof(recordHeader, recordLength));
+        while (position + TLV_FIELD_HEADER_BYTES <= end) {
+            uint8_t fieldTag = Storage::read(position);
+            uint8_t fieldLength = Storage::read(position + 1);
+            if (position + TLV_FIELD_HEADER_BYTES + fieldLength > end) break;
+            if (fieldTag == tag) {
+                address = position + TLV_FIELD_HEADER_BYTES;
+                length = fieldLength;
+                return true;
+            }
+            position += TLV_FIELD_HEADER_BYTES + fieldLength;
+        }
+        return false;
+    }
+
+    /**
+     * @brief copies a string field of the newest TLV record into `buffer`, null terminated (truncated if needed).
+     * @return false if the field is not stored (buffer untouched).
+     */
+    inline bool readTLVString(uint8_t tag, char *buffer, size_t bufferSize) {
+        uint16_t address;
+        uint8_t length;
+        if (bufferSize == 0 || !findTLVField(tag, address, length)) {
+            return false;
+        }
+        if (length > bufferSize - 1) length = bufferSize - 1;
+        readBlock(address, buffer, length);
+        buffer[length] = '\0';
+        return true;
+    }
+
+    /**
+     * @brief reads a one byte field (e.g. TLV_PROJECT_VERSION) of the newest TLV record.
+     * @return false if the field is not stored or is not one byte long.
+     */
+    inline bool readTLVByte(uint8_t tag, uint8_t &value) {
+        uint16_t address;
+        uint8_t length;
+        if (!findTLVField(tag, address, length) || length != 1) {
+            return false;
+        }
+        value = Storage::read(address);
+        return true;
+    }
+
+    /**
+     * @brief reads the TLV_FINGERPRINT field of the newest TLV record, e.g. to compare it with CONFIGURED_FINGERPRINT.
+     * @return false if the field is not stored or is not four bytes long.
+     */
+    inline bool readTLVFingerprint(uint32_t &fingerprint) {
+        uint16_t address;
+        uint8_t length;
+        if (!findTLVField(TLV_FINGERPRINT, address, length) || length != sizeof(fingerprint)) {
+            return false;
+        }
+        readBlock(address, &fingerprint, sizeof(fingerprint));
+        return true;
+    }
+}
+
+#endif // EEPROM_VC_TLV_H
@@ -0,0 +1,16 @@
+/**
+ * Compiled part of EEPROM_Version_Control.h, used when EEPROM_VC_COMPILED is defined for the whole build (e.g.
+ * build_flags = -D EEPROM_VC_COMPILED in platformio.ini). The writing, reading and printing functions are then
+ * compiled once here instead of inline in every file that calls them, and with -ffunction-sections and
+ * --gc-sections (the Arduino default) the linker drops the ones the program never calls, the print path included.
+ *
+ * Every file of the program has to see the same CL_Version_Data.conf, geometry and backend as this one, so an
+ * EEPROM_VC_GEOMETRY or EEPROM_VC_BACKEND is defined for the whole build too. Backends from other headers, like
+ * EEPROM_VC_External.h, need the header-only mode. Without EEPROM_VC_COMPILED (the default) this file compiles to
+ * nothing, since the Arduino IDE builds every .cpp in src/.
+ */
+
+#ifdef EEPROM_VC_COMPILED
+#define EEPROM_VC_IMPLEMENTATION
+#include <EEPROM_Version_Control.h>
+#endif
@@ -12,6 +12,7 @@
  * Currently this stores several values in EEPROM:
  *  dataWritten: a flag used to determine if data was previously stored on the EEPROM in this location
  *  libraryVersion: the version number of this library that wrote the data into the EEPROM. Used to ensure compatibility with future versions
+ *  recordLength, crc: length and CRC-16 of the fields below, so partially written or random data is never mistaken for a record
  *  projectName: the project projectName, not to exceed 1 character
  *  vendor: the name of the vendor this was provided to, not to exceed 7 characters
  *  projectVersion: the version number of the project (e.g., set to 2 if this is v2 of PLANT)
@@ -19,26 +20,57 @@
  *  finalSoftwareDate: the date that the compiled version of your project code was made and supplied to the vendor. Spell month names for clarity. 18 characters max.
  */
 
+#ifndef EEPROM_VERSION_CONTROL_H
+#define EEPROM_VERSION_CONTROL_H
+
+#ifdef ARDUINO
 #include <Arduino.h>
-#include <EEPROM.h>
+#else
+#include <EEPROM_VC_Host.h>     // lets the library build on a desktop host against a simulated EEPROM
+#endif
+#include <EEPROM_VC_Backend.h>
 #include <CL_Version_Data.conf>
 
+// By default the library is header-only and all of its functions are inline, so any number of files can include it.
+// With EEPROM_VC_COMPILED defined for the whole build, the writing, reading and printing functions below are only
+// declared here and compiled once, in EEPROM_Version_Control.cpp (see the end of this file).
+#ifdef EEPROM_VC_COMPILED
+#define EEPROM_VC_FUNCTION
+#else
+#define EEPROM_VC_FUNCTION inline
+#endif
+
 namespace EEPROMVersionControl {
     // DO NOT CHANGE
     // important values for data storage
-    constexpr uint16_t EEPROM_SIZE_BYTES = E2END;            // size of EEPROM on the ATMega328P Arduino Nano
-    constexpr uint16_t RESERVED_BYTES = 60;                  // the number of bytes reserved for this data at the end of the EEPROM   
-    constexpr uint16_t VERSION_DATA_START_ADDRESS = EEPROM_SIZE_BYTES - RESERVED_BYTES;  // starting address for this data block
+    constexpr uint32_t EEPROM_SIZE_BYTES = Geometry::SIZE_BYTES;            // size of the EEPROM (see EEPROM_VC_Geometry.h)
+    constexpr uint16_t RESERVED_BYTES = VERSION_DATA_RESERVED_BYTES;         // the minimum number of bytes reserved for this data
+    constexpr uint16_t AUTO_PLACEMENT = 0xFFFF;             // VERSION_DATA_BASE_ADDRESS value that puts the data at the end of the EEPROM
     constexpr uint16_t DATA_EXISTS_MAGIC_NUMBER = 42;       // this serves as a flag to indicate that data was previously stored in EEPROM
-    constexpr uint8_t LIBRARY_VERSION = 1;                  // DO NOT CHANGE - USED TO TRACK COMPATIBILITY WITH FUTURE VERSIONS OF THIS LIBRARY
+    constexpr uint8_t LIBRARY_VERSION = 2;                  // DO NOT CHANGE - USED TO TRACK COMPATIBILITY WITH FUTURE VERSIONS OF THIS LIBRARY
+                                                            // 1: original layout, 2: adds recordLength, a CRC-16 of the payload
+                                                            // and the fingerprint of the values
 
     // store strings for print debugs in PROGMEM with constants. reduces RAM useage.
-    const char PROGMEM PRINT_PROJECT_NAME[] = "Project Name: ";
-    const char PROGMEM PRINT_VENDOR_NAME[] = "Vendor: ";
-    const char PROGMEM PRINT_PROJECT_NAME_VERSION[] = "Project Version: ";
-    const char PROGMEM PRINT_SOFTWARE_VERSION[] = "Software Version: ";
-    const char PROGMEM PRINT_SOFTWARE_DATE[] = "Software Date: ";
-    const char PROGMEM PRINT_DATA_DNE[] = "Version data does not exist.";
+    // They are static members of a class template (like ConfiguredRecord below), so however many files include this
+    // header, the program holds one copy, and only if something prints.
+    template <typename = void> struct printStrings {
+        static const char PRINT_PROJECT_NAME[];
+        static const char PRINT_VENDOR_NAME[];
+        static const char PRINT_PROJECT_NAME_VERSION[];
+        static const char PRINT_SOFTWARE_VERSION[];
+        static const char PRINT_SOFTWARE_DATE[];
+        static const char PRINT_DATA_DNE[];
+        static const char PRINT_LIBRARY_VERSION[];
+    };
+    template <typename T> const char printStrings<T>::PRINT_PROJECT_NAME[] PROGMEM = "Project Name: ";
+    template <typename T> const char printStrings<T>::PRINT_VENDOR_NAME[] PROGMEM = "Vendor: ";
+    template <typename T> const char printStrings<T>::PRINT_PROJECT_NAME_VERSION[] PROGMEM = "Project Version: ";
+    template <typename T> const char printStrings<T>::PRINT_SOFTWARE_VERSION[] PROGMEM = "Software Version: ";
+    template <typename T> const char printStrings<T>::PRINT_SOFTWARE_DATE[] PROGMEM = "Software Date: ";
+    template <typename T> const char printStrings<T>::PRINT_DATA_DNE[] PROGMEM = "Version data does not exist.";
+    template <typename T> const char printStrings<T>::PRINT_LIBRARY_VERSION[] PROGMEM = "Library version: ";
+    typedef printStrings<> PrintStrings;
 
 
     /**
@@ -49,46 +81,700 @@ namespace EEPROMVersionControl {
         dest[destSize - 1] = '\0';  // Ensure null termination
     }
 
+    /**
+     * @brief copies `length` bytes starting at `address` out of the storage backend into `dest`.
+     */
+    inline void readBlock(uint16_t address, void *dest, size_t length) {
+        uint8_t *bytes = static_cast<uint8_t *>(dest);
+        for (size_t i = 0; i < length; i++) {
+            bytes[i] = Storage::read(address + i);
+        }
+    }
+
+    /**
+     * @brief What a write to EEPROM actually cost.
+     */
+    struct WriteResult {
+        uint16_t bytesWritten;          // number of cells that went through an erase+write cycle
+        uint32_t estimatedMicros;       // number of write cycles (bytes, or page bursts) * the backend's write time
+        bool failed;                    // the backend reported a failed write; nothing was written after it
+
+        uint32_t estimatedMillis() const { return (estimatedMicros + 500) / 1000; }
+
+        WriteResult &operator+=(const WriteResult &other) {
+            bytesWritten += other.bytesWritten;
+            estimatedMicros += other.estimatedMicros;
+            failed = failed || other.failed;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Bytes to be written to or compared against EEPROM, located either in RAM or in flash (PROGMEM).
+     */
+    struct ByteSource {
+        const uint8_t *bytes;
+        bool inProgmem;
+
+        uint8_t operator[](size_t i) const { return inProgmem ? pgm_read_byte(bytes + i) : bytes[i]; }
+        ByteSource operator+(size_t offset) const { return ByteSource{bytes + offset, inProgmem}; }
+    };
+
+    template <bool Bursts> struct burstWriteTag {};
+
+    /**
+     * @brief writeBlock() for backends that write single bytes: every byte that differs is one write.
+     */
+    inline WriteResult writeBlock(uint16_t address, ByteSource src, size_t length, burstWriteTag<false>) {
+        WriteResult result = {0, 0, false};
+        for (size_t i = 0; i < length; i++) {
+            uint8_t value = src[i];
+            if (Storage::read(address + i) != value) {
+                Storage::write(address + i, value);
+                result.bytesWritten++;
+            }
+        }
+        result.estimatedMicros = static_cast<uint32_t>(result.bytesWritten) * Storage::WRITE_TIME_US;
+        return result;
+    }
+
+    /**
+     * @brief writeBlock() for backends with writePage(): on each Geometry page, the span from the first to the
+     * last byte that differs is rewritten in bursts of at most MAX_BURST_BYTES, each one write cycle. A burst
+     * never crosses a page boundary, where page-programmed parts would wrap around to the start of the page.
+     * Stops at the first burst writePage() reports as failed.
+     */
+    template <typename Backend = Storage>
+    WriteResult writeBlock(uint16_t address, ByteSource src, size_t length, burstWriteTag<true>) {
+        WriteResult result = {0, 0, false};
+        uint8_t burst[backendBurstBytes<Backend>::value];
+        size_t i = 0;
+        while (i < length) {
+            size_t pageEnd = (static_cast<size_t>(address + i) / Geometry::PAGE_BYTES + 1) * Geometry::PAGE_BYTES - address;
+            if (pageEnd > length) pageEnd = length;
+            size_t first = pageEnd;
+            size_t last = i;
+            for (size_t j = i; j < pageEnd; j++) {
+                if (Backend::read(address + j) != src[j]) {
+                    if (first == pageEnd) first = j;
+                    last = j + 1;
+                }
+            }
+            while (first < last) {
+                uint8_t count = (last - first < sizeof(burst)) ? last - first : sizeof(burst);
+                for (uint8_t k = 0; k < count; k++) {
+                    burst[k] = src[first + k];
+                }
+                if (!Backend::writePage(address + first, burst, count)) {
+                    result.failed = true;
+                    return result;
+                }
+                result.bytesWritten += count;
+                result.estimatedMicros += Backend::WRITE_TIME_US;
+                first += count;
+            }
+            i = pageEnd;
+        }
+        return result;
+    }
+
+    /**
+     * @brief diff-writes `length` bytes from `src` to the storage backend starting at `address`.
+     * 
+     * The stored image is read back first and only cells whose value differs are written, so rewriting
+     * identical data costs no write time and no wear. Backends that program whole pages get the changes
+     * in page bursts (see above).
+     * 
+     * @return how many bytes were written and the estimated time spent doing it, and whether a write failed.
+     */
+    inline WriteResult writeBlock(uint16_t address, ByteSource src, size_t length) {
+        return writeBlock(address, src, length, burstWriteTag<(STORAGE_BURST_BYTES > 1)>());
+    }
+
+    inline WriteResult writeBlock(uint16_t address, const void *src, size_t length) {
+        return writeBlock(address, ByteSource{static_cast<const uint8_t *>(src), false}, length);
+    }
+
+    // CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) lookup table, one entry per nibble.
+    // 32 bytes of flash instead of 512 for a full byte table, at the cost of two lookups per byte.
+    template <typename = void> struct crc16NibbleTable {
+        static const uint16_t entries[16];
+    };
+    template <typename T> const uint16_t crc16NibbleTable<T>::entries[16] PROGMEM = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+    typedef crc16NibbleTable<> CRC16NibbleTable;
+    constexpr uint16_t CRC16_INITIAL_VALUE = 0xFFFF;
+
+    /**
+     * @brief feeds one byte into a running CRC-16/CCITT.
+     */
+    inline uint16_t crc16Update(uint16_t crc, uint8_t value) {
+        crc = (crc << 4) ^ pgm_read_word(&CRC16NibbleTable::entries[((crc >> 12) ^ (value >> 4)) & 0x0F]);
+        crc = (crc << 4) ^ pgm_read_word(&CRC16NibbleTable::entries[((crc >> 12) ^ value) & 0x0F]);
+        return crc;
+    }
+
+    /**
+     * @brief CRC-16/CCITT of a block in RAM.
+     */
+    inline uint16_t crc16(const void *src, size_t length) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(src);
+        uint16_t crc = CRC16_INITIAL_VALUE;
+        for (size_t i = 0; i < length; i++) {
+            crc = crc16Update(crc, bytes[i]);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief CRC-16/CCITT of a block in EEPROM, streamed byte by byte from the storage backend (no RAM buffer).
+     */
+    inline uint16_t crc16OfStorage(uint16_t address, size_t length) {
+        uint16_t crc = CRC16_INITIAL_VALUE;
+        for (size_t i = 0; i < length; i++) {
+            crc = crc16Update(crc, Storage::read(address + i));
+        }
+        return crc;
+    }
+
+    /**
+     * @brief The header at the start of every stored record. Mirrors the first fields of versionData.
+     */
+    struct recordHeader {
+        uint16_t dataWritten;          // DATA_EXISTS_MAGIC_NUMBER
+        uint8_t libraryVersion;        // LIBRARY_VERSION of the code that wrote the record
+        uint8_t recordLength;          // number of payload bytes following the header
+        uint16_t crc;                  // CRC-16/CCITT of those payload bytes
+    };
+
+    struct versionData;
+    inline void updateFingerprint(versionData &data);
+
     /**
      * @brief Struct for storing version control data in EEPROM.
      * 
      * This struct holds information about the projectName, vendor, project version, 
-     * software version, and the final software date. It is designed to fit 
-     * within the reserved EEPROM space. Currently 55 bytes of 60 reserved bytes are used.
+     * software version, and the final software date, followed by their fingerprint (see versionFingerprint()).
+     * The record is 61 bytes; the version data region grows past VERSION_DATA_RESERVED_BYTES to fit it.
+     * 
+     * The first four fields are the record header (see recordHeader). recordLength and crc are
+     * computed by writeDataToEEPROM(), so they don't need to be kept up to date in RAM. The constructor and the
+     * set functions keep the fingerprint up to date; call updateFingerprint() after changing a field directly.
      */
     struct versionData {
         uint16_t dataWritten;          // if set to exactly DATA_EXISTS_MAGIC_NUMBER, there is version control data written. if false, data needs to be written. 
         uint8_t libraryVersion;        // version of this library code (EEPROM_Version_Control.h) that was used to store the data in EEPROM
+        uint8_t recordLength;          // number of bytes from projectName through finalSoftwareDate
+        uint16_t crc;                  // CRC-16/CCITT over those bytes, used to reject partially written or random data
         char projectName[21];          // e.g., "Tank Plant". Use official name, not the SKU. Max 20 characters.
         char vendor[2];                // "M" or "N" (or for future vendors, single first letter of their name)
         uint8_t projectVersion;        // 1 for version 1, 2 for version 2, 3 for reorder.
         char softwareVersion[8];       // e.g., "1.0.0.0", or similar for a max of 7 characters (honestly however you want to do it, within 7 characters)
         char finalSoftwareDate[19];    // e.g., "September 23, 2024" (this example is longest possible at 18 bytes) (I like writing month name for clarity)
+        uint8_t fingerprint[4];        // versionFingerprint() of the fields above, little endian like the header
 
         // constructor
         versionData()
             : dataWritten(DATA_EXISTS_MAGIC_NUMBER),
               libraryVersion(LIBRARY_VERSION),
+              recordLength(0),
+              crc(0),
               projectVersion(PROJECT_VERSION) {
                 safeStrCopy(projectName, PROJECT_NAME, sizeof(projectName));
                 safeStrCopy(vendor, VENDOR, sizeof(vendor));
                 safeStrCopy(softwareVersion, SOFTWARE_VERSION, sizeof(softwareVersion));
                 safeStrCopy(finalSoftwareDate, SOFTWARE_DATE, sizeof(finalSoftwareDate));
                 finalSoftwareDate[sizeof(finalSoftwareDate) - 1] = '\0';  // Ensure null termination
+                updateFingerprint(*this);
               }
     };
 
-    // Compile-time assertion to ensure the struct fits within the reserved EEPROM space
-    static_assert(sizeof(versionData) <= RESERVED_BYTES, "versionData exceeds reserved EEPROM size!");
+    // bytes of versionData that are stored in EEPROM (sizeof() may add tail padding on 32/64 bit hosts)
+    constexpr uint16_t RECORD_HEADER_BYTES = offsetof(versionData, projectName);
+    constexpr uint16_t RECORD_BYTES = offsetof(versionData, fingerprint) + sizeof(versionData::fingerprint);
+    constexpr uint8_t RECORD_PAYLOAD_BYTES = RECORD_BYTES - RECORD_HEADER_BYTES;
+
+    static_assert(sizeof(recordHeader) == RECORD_HEADER_BYTES, "recordHeader must match the first fields of versionData");
+
+    ///////////////////////////////////////////////////////////////////////
+    // Fingerprint of the version data
+    ///////////////////////////////////////////////////////////////////////
+
+    // A 32 bit FNV-1a hash of the five values, so tools can compare a build with a device by one integer.
+    // The hashed bytes are: projectName, vendor, projectVersion (one byte), softwareVersion, finalSoftwareDate,
+    // where each string contributes its characters (truncated to the field size, as stored) and a terminating 0.
+    // Only the values count, not the record layout, so the same data gives the same fingerprint in every format.
+    // versionData records store it after the values (LIBRARY_VERSION 2), TLV records as their TLV_FINGERPRINT field.
+    constexpr uint32_t FNV1A_OFFSET_BASIS = 0x811C9DC5UL;
+    constexpr uint32_t FNV1A_PRIME = 0x01000193UL;
+
+    constexpr uint32_t fnv1aUpdate(uint32_t hash, uint8_t value) {
+        return (hash ^ value) * FNV1A_PRIME;
+    }
+
+    /**
+     * @brief feeds a string field into a running fingerprint: at most `maxLength` characters, then a 0.
+     */
+    constexpr uint32_t fnv1aString(uint32_t hash, const char *str, size_t maxLength) {
+        return (maxLength == 0 || *str == '\0') ? fnv1aUpdate(hash, 0)
+                                                : fnv1aString(fnv1aUpdate(hash, static_cast<uint8_t>(*str)), str + 1, maxLength - 1);
+    }
+
+    /**
+     * @brief the fingerprint of a set of version data values. constexpr, so it also works on compile-time strings.
+     */
+    constexpr uint32_t versionFingerprint(const char *projectName, const char *vendor, uint8_t projectVersion,
+                                          const char *softwareVersion, const char *finalSoftwareDate) {
+        return fnv1aString(fnv1aString(fnv1aUpdate(fnv1aString(fnv1aString(FNV1A_OFFSET_BASIS,
+                   projectName, sizeof(versionData::projectName) - 1),
+                   vendor, sizeof(versionData::vendor) - 1),
+                   projectVersion),
+                   softwareVersion, sizeof(versionData::softwareVersion) - 1),
+                   finalSoftwareDate, sizeof(versionData::finalSoftwareDate) - 1);
+    }
 
     /**
-     * @brief check to see if version data is stored in the last 50 bytes of the EEPROM.
-     * @return returns true iff the data written flag == DATA_EXISTS_MAGIC_NUMBER
+     * @brief The fingerprint of the values in CL_Version_Data.conf, computed by the compiler.
+     */
+    constexpr uint32_t CONFIGURED_FINGERPRINT = versionFingerprint(PROJECT_NAME, VENDOR, PROJECT_VERSION, SOFTWARE_VERSION, SOFTWARE_DATE);
+
+    /**
+     * @brief the fingerprint of the values in a versionData struct.
+     */
+    inline uint32_t versionFingerprint(const versionData &data) {
+        return versionFingerprint(data.projectName, data.vendor, data.projectVersion, data.softwareVersion, data.finalSoftwareDate);
+    }
+
+    /**
+     * @brief the fingerprint held in data.fingerprint (which may be out of date, see fingerprintIsCurrent()).
+     */
+    inline uint32_t storedFingerprint(const versionData &data) {
+        return static_cast<uint32_t>(data.fingerprint[0]) | static_cast<uint32_t>(data.fingerprint[1]) << 8
+               | static_cast<uint32_t>(data.fingerprint[2]) << 16 | static_cast<uint32_t>(data.fingerprint[3]) << 24;
+    }
+
+    /**
+     * @brief true if data.fingerprint matches the values in data.
+     */
+    inline bool fingerprintIsCurrent(const versionData &data) {
+        return storedFingerprint(data) == versionFingerprint(data);
+    }
+
+    /**
+     * @brief sets data.fingerprint to the fingerprint of the values in data.
+     */
+    inline void updateFingerprint(versionData &data) {
+        const uint32_t fingerprint = versionFingerprint(data);
+        for (uint8_t i = 0; i < sizeof(data.fingerprint); i++) {
+            data.fingerprint[i] = static_cast<uint8_t>(fingerprint >> (8 * i));
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // Compile-time record image of the values in CL_Version_Data.conf
+    ///////////////////////////////////////////////////////////////////////
+
+    // The complete EEPROM record (header, CRC and payload) for the configured values is built by the compiler
+    // and stored in flash, so writeDataToEEPROM() can copy flash to EEPROM without a versionData in RAM.
+    // The byte order of the multi-byte header fields is little endian, which is what AVR (and the hosts the
+    // tools run on) use.
+
+    /**
+     * @brief byte `i` of a string field holding `str`, with the same truncation and zero padding as safeStrCopy().
+     */
+    constexpr uint8_t stringFieldByte(const char *str, size_t strSize, size_t fieldSize, size_t i) {
+        return (i + 1 < fieldSize && i < strSize) ? static_cast<uint8_t>(str[i]) : 0;
+    }
+
+    /**
+     * @brief byte at record offset `offset` (RECORD_HEADER_BYTES <= offset < RECORD_BYTES) of the configured payload.
+     */
+    constexpr uint8_t configuredPayloadByte(size_t offset) {
+        return offset < offsetof(versionData, vendor)
+                   ? stringFieldByte(PROJECT_NAME, sizeof(PROJECT_NAME), sizeof(versionData::projectName), offset - offsetof(versionData, projectName))
+             : offset < offsetof(versionData, projectVersion)
+                   ? stringFieldByte(VENDOR, sizeof(VENDOR), sizeof(versionData::vendor), offset - offsetof(versionData, vendor))
+             : offset < offsetof(versionData, softwareVersion)
+                   ? PROJECT_VERSION
+             : offset < offsetof(versionData, finalSoftwareDate)
+                   ? stringFieldByte(SOFTWARE_VERSION, sizeof(SOFTWARE_VERSION), sizeof(versionData::softwareVersion), offset - offsetof(versionData, softwareVersion))
+             : offset < offsetof(versionData, fingerprint)
+                   ? stringFieldByte(SOFTWARE_DATE, sizeof(SOFTWARE_DATE), sizeof(versionData::finalSoftwareDate), offset - offsetof(versionData, finalSoftwareDate))
+                   : static_cast<uint8_t>(CONFIGURED_FINGERPRINT >> (8 * (offset - offsetof(versionData, fingerprint))));
+    }
+
+    static_assert(offsetof(versionData, vendor) == offsetof(versionData, projectName) + sizeof(versionData::projectName)
+                  && offsetof(versionData, projectVersion) == offsetof(versionData, vendor) + sizeof(versionData::vendor)
+                  && offsetof(versionData, softwareVersion) == offsetof(versionData, projectVersion) + 1
+                  && offsetof(versionData, finalSoftwareDate) == offsetof(versionData, softwareVersion) + sizeof(versionData::softwareVersion)
+                  && offsetof(versionData, fingerprint) == offsetof(versionData, finalSoftwareDate) + sizeof(versionData::finalSoftwareDate),
+                  "configuredPayloadByte() assumes the versionData payload fields have no padding between them");
+
+    /**
+     * @brief compile-time (bit at a time) version of crc16Update(), used to build the record image.
+     */
+    constexpr uint16_t crc16Shift(uint16_t crc, uint8_t bits) {
+        return bits == 0 ? crc : crc16Shift(static_cast<uint16_t>((crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1)), bits - 1);
+    }
+
+    constexpr uint16_t configuredPayloadCrc(size_t offset = RECORD_HEADER_BYTES, uint16_t crc = CRC16_INITIAL_VALUE) {
+        return offset == RECORD_BYTES ? crc : configuredPayloadCrc(offset + 1, crc16Shift(crc ^ (configuredPayloadByte(offset) << 8), 8));
+    }
+
+    constexpr uint16_t CONFIGURED_PAYLOAD_CRC = configuredPayloadCrc();
+
+    /**
+     * @brief byte `offset` of the complete configured record, header included.
+     */
+    constexpr uint8_t configuredRecordByte(size_t offset) {
+        return offset == offsetof(versionData, dataWritten)         ? DATA_EXISTS_MAGIC_NUMBER & 0xFF
+             : offset == offsetof(versionData, dataWritten) + 1     ? DATA_EXISTS_MAGIC_NUMBER >> 8
+             : offset == offsetof(versionData, libraryVersion)      ? LIBRARY_VERSION
+             : offset == offsetof(versionData, recordLength)        ? RECORD_PAYLOAD_BYTES
+             : offset == offsetof(versionData, crc)                 ? CONFIGURED_PAYLOAD_CRC & 0xFF
+             : offset == offsetof(versionData, crc) + 1             ? CONFIGURED_PAYLOAD_CRC >> 8
+             : configuredPayloadByte(offset);
+    }
+
+    // compile-time list of indices 0..N-1, used to expand configuredRecordByte() into an array initializer
+    template <size_t... I> struct indexList {};
+    template <size_t N, size_t... I> struct makeIndexList : makeIndexList<N - 1, N - 1, I...> {};
+    template <size_t... I> struct makeIndexList<0, I...> { typedef indexList<I...> type; };
+
+    template <typename Indices> struct configuredRecordImage;
+    template <size_t... I> struct configuredRecordImage<indexList<I...>> {
+        static const uint8_t bytes[sizeof...(I)];
+    };
+    template <size_t... I> const uint8_t configuredRecordImage<indexList<I...>>::bytes[sizeof...(I)] PROGMEM = { configuredRecordByte(I)... };
+
+    /**
+     * @brief The configured record as it appears in EEPROM, RECORD_BYTES long, stored in flash.
+     * Read it with pgm_read_byte(), e.g. pgm_read_byte(&ConfiguredRecord::bytes[i]).
+     */
+    typedef configuredRecordImage<makeIndexList<RECORD_BYTES>::type> ConfiguredRecord;
+
+    ///////////////////////////////////////////////////////////////////////
+    // Slot layout (wear leveling)
+    ///////////////////////////////////////////////////////////////////////
+
+    // SLOT_COUNT is VERSION_DATA_SLOTS, raised to 2 when ATOMIC_UPDATES needs a shadow slot.
+    // With SLOT_COUNT == 1 the record lives at VERSION_DATA_START_ADDRESS, in a region of RESERVED_BYTES or the
+    // record size, whichever is larger.
+    // With more slots, each slot is a 2 byte sequence number followed by a versionData record, and the
+    // slots are packed into a region of SLOT_COUNT slots (or RESERVED_BYTES, whichever is larger).
+    //
+    // The region is placed using the Geometry. On parts that program whole pages (PAGE_BYTES > 1) every slot is
+    // rounded up to a page and starts on a page boundary, so a record is written in as few page writes as possible.
+    // With VERSION_DATA_BASE_ADDRESS == AUTO_PLACEMENT the region ends one byte before the end of the EEPROM, where
+    // earlier library versions put it, and its start is rounded down to a page, or to an erase block if the region
+    // spans at least one. Otherwise it starts at VERSION_DATA_BASE_ADDRESS, which must be page aligned.
+    //
+    // The layout functions take the record size, so EEPROM_VC_Migration.h can find the smaller records of earlier
+    // library versions with the same options.
+    constexpr uint8_t SLOT_COUNT = (ATOMIC_UPDATES && VERSION_DATA_SLOTS < 2) ? 2 : VERSION_DATA_SLOTS;
+    constexpr uint16_t SLOT_HEADER_BYTES = (SLOT_COUNT > 1) ? sizeof(uint16_t) : 0;
+
+    constexpr uint16_t slotBytesFor(uint16_t recordBytes) {
+        return (SLOT_HEADER_BYTES + recordBytes + Geometry::PAGE_BYTES - 1) / Geometry::PAGE_BYTES * Geometry::PAGE_BYTES;
+    }
+
+    constexpr uint16_t regionBytesFor(uint16_t recordBytes) {
+        return (SLOT_COUNT * slotBytesFor(recordBytes) > RESERVED_BYTES) ? SLOT_COUNT * slotBytesFor(recordBytes) : RESERVED_BYTES;
+    }
+
+    constexpr uint16_t regionAlignmentFor(uint16_t recordBytes) {
+        return (Geometry::ERASE_BYTES > Geometry::PAGE_BYTES && Geometry::ERASE_BYTES <= regionBytesFor(recordBytes))
+                   ? Geometry::ERASE_BYTES : Geometry::PAGE_BYTES;
+    }
+
+    constexpr uint16_t regionStartFor(uint16_t recordBytes) {
+        return (VERSION_DATA_BASE_ADDRESS != AUTO_PLACEMENT)
+                   ? VERSION_DATA_BASE_ADDRESS
+                   : (EEPROM_SIZE_BYTES - 1 - regionBytesFor(recordBytes)) / regionAlignmentFor(recordBytes) * regionAlignmentFor(recordBytes);
+    }
+
+    constexpr uint16_t SLOT_BYTES = slotBytesFor(RECORD_BYTES);
+    constexpr uint16_t VERSION_DATA_REGION_BYTES = regionBytesFor(RECORD_BYTES);
+    static_assert(VERSION_DATA_REGION_BYTES < EEPROM_SIZE_BYTES, "the version data region is larger than the EEPROM!");
+    constexpr uint16_t VERSION_DATA_REGION_START = regionStartFor(RECORD_BYTES);
+    constexpr uint32_t VERSION_DATA_END_ADDRESS = static_cast<uint32_t>(VERSION_DATA_REGION_START) + VERSION_DATA_REGION_BYTES;
+    constexpr uint16_t VERSION_DATA_START_ADDRESS = VERSION_DATA_REGION_START;   // starting address for this data block
+    // largest payload a slot can hold. A single slot may use all of the reserved bytes; ring slots are SLOT_BYTES apart.
+    constexpr uint16_t MAX_PAYLOAD_BYTES = ((SLOT_COUNT == 1) ? VERSION_DATA_REGION_BYTES : SLOT_BYTES - SLOT_HEADER_BYTES) - RECORD_HEADER_BYTES;
+    constexpr uint8_t NO_SLOT = 0xFF;
+    constexpr uint8_t UNCOMMITTED_MARKER = 0x00;    // written over the commit byte while a slot is being rewritten
+
+    /**
+     * @brief a byte holding UNCOMMITTED_MARKER, to write from. One object for the whole program: taking the address of
+     * the constant itself would give every file its own copy.
+     */
+    inline const uint8_t *uncommittedMarker() {
+        static const uint8_t marker = UNCOMMITTED_MARKER;
+        return &marker;
+    }
+
+    static_assert(VERSION_DATA_SLOTS >= 1 && VERSION_DATA_SLOTS < NO_SLOT, "VERSION_DATA_SLOTS must be between 1 and 254");
+    static_assert(static_cast<uint32_t>(SLOT_COUNT) * SLOT_BYTES <= 0xFFFF, "VERSION_DATA_SLOTS slots do not fit in the EEPROM!");
+    static_assert(VERSION_DATA_END_ADDRESS <= EEPROM_SIZE_BYTES, "the version data region does not fit in the EEPROM!");
+    static_assert(VERSION_DATA_REGION_START % Geometry::PAGE_BYTES == 0, "VERSION_DATA_BASE_ADDRESS must be a multiple of the EEPROM page size");
+
+    /**
+     * @brief EEPROM address of the start of a slot (its sequence number, if it has one).
+     */
+    constexpr uint16_t slotAddress(uint8_t slot) {
+        return VERSION_DATA_REGION_START + slot * SLOT_BYTES;
+    }
+
+    /**
+     * @brief EEPROM address of the versionData record held in a slot.
+     */
+    constexpr uint16_t recordAddress(uint8_t slot) {
+        return slotAddress(slot) + SLOT_HEADER_BYTES;
+    }
+
+    /**
+     * @brief true if sequence number a was written after b. Handles wraparound of the 16 bit counter.
+     */
+    constexpr bool sequenceIsNewer(uint16_t a, uint16_t b) {
+        return static_cast<int16_t>(a - b) > 0;
+    }
+
+    /**
+     * @brief true if the slot holds a complete record written by this library version.
+     * 
+     * Checks the magic number, library version and length in the header, then runs the CRC over the payload
+     * straight from EEPROM. Nothing is copied into a versionData struct.
+     * 
+     * @param magic the record format to look for. DATA_EXISTS_MAGIC_NUMBER (the default) is the fixed versionData
+     *              layout, which must have exactly RECORD_PAYLOAD_BYTES of payload. Other formats (e.g. the TLV
+     *              records in EEPROM_VC_TLV.h) use their own magic number and may have any length that fits a slot.
+     */
+    inline bool slotIsValid(uint8_t slot, uint16_t magic = DATA_EXISTS_MAGIC_NUMBER) {
+        recordHeader header;
+        readBlock(recordAddress(slot), &header, sizeof(header));
+        bool lengthIsValid = (magic == DATA_EXISTS_MAGIC_NUMBER) ? (header.recordLength == RECORD_PAYLOAD_BYTES)
+                                                                 : (header.recordLength <= MAX_PAYLOAD_BYTES);
+        if (header.dataWritten != magic
+            || header.libraryVersion != LIBRARY_VERSION
+            || !lengthIsValid) {
+            return false;
+        }
+        return crc16OfStorage(recordAddress(slot) + RECORD_HEADER_BYTES, header.recordLength) == header.crc;
+    }
+
+    /**
+     * @brief the magic number stored in a slot, i.e. the format of the record it holds if slotIsValid(slot, magic).
+     */
+    inline uint16_t storedMagic(uint8_t slot) {
+        uint16_t magic = 0;
+        readBlock(recordAddress(slot) + offsetof(recordHeader, dataWritten), &magic, sizeof(magic));
+        return magic;
+    }
+
+    /**
+     * @brief finds the slot holding the most recently written valid record, of any format (versionData, TLV, ...).
+     * 
+     * This is a single pass over the slots that validates each one and reads its sequence number, so its cost
+     * is bounded by SLOT_COUNT no matter how often the data has been rewritten.
+     * 
+     * @param sequence set to the sequence number of the newest record (untouched if there is none).
+     * @param magic set to the format of the newest record (untouched if there is none).
+     * @return the slot index, or NO_SLOT if no slot holds a valid record.
+     */
+    inline uint8_t findNewestRecord(uint16_t &sequence, uint16_t &magic) {
+        uint8_t newest = NO_SLOT;
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            const uint16_t slotMagic = storedMagic(slot);
+            if (Storage::read(recordAddress(slot)) == UNCOMMITTED_MARKER || !slotIsValid(slot, slotMagic)) continue;
+            uint16_t slotSequence = 0;
+            readBlock(slotAddress(slot), &slotSequence, SLOT_HEADER_BYTES);
+            if (newest == NO_SLOT || sequenceIsNewer(slotSequence, sequence)) {
+                newest = slot;
+                sequence = slotSequence;
+                magic = slotMagic;
+            }
+        }
+        return newest;
+    }
+
+    /**
+     * @brief finds the slot holding the most recently written valid record of one format.
+     * 
+     * The slots hold one format at a time, so a record counts only if it is the newest record of any format. An
+     * older record of another format left behind by a cut during a format switch is never returned.
+     * 
+     * @param sequence set to the sequence number of the newest record (untouched if there is none).
+     * @param magic the record format to look for (see slotIsValid()).
+     * @return the slot index, or NO_SLOT if the newest record is of another format or there is none.
+     */
+    inline uint8_t findNewestSlot(uint16_t &sequence, uint16_t magic = DATA_EXISTS_MAGIC_NUMBER) {
+        uint16_t newestSequence = 0;
+        uint16_t newestMagic = magic;
+        const uint8_t newest = findNewestRecord(newestSequence, newestMagic);
+        if (newest == NO_SLOT || newestMagic != magic) {
+            return NO_SLOT;
+        }
+        sequence = newestSequence;
+        return newest;
+    }
+
+    inline uint8_t findNewestSlot() {
+        uint16_t sequence = 0;
+        return findNewestSlot(sequence);
+    }
+
+    /**
+     * @brief true if the `length` bytes stored at `address` equal `src`. Reads straight from EEPROM, no RAM copy.
+     */
+    inline bool blockMatches(uint16_t address, ByteSource src, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            if (Storage::read(address + i) != src[i]) return false;
+        }
+        return true;
+    }
+
+    inline bool blockMatches(uint16_t address, const void *src, size_t length) {
+        return blockMatches(address, ByteSource{static_cast<const uint8_t *>(src), false}, length);
+    }
+
+    /**
+     * @brief checks that valid version data is stored in EEPROM, without reading it into RAM.
+     * 
+     * A record is valid if its magic number, library version and length match and the CRC-16 of its payload
+     * is correct, so a block torn by a brownout or random EEPROM contents are rejected.
+     * 
+     * @return true if at least one slot holds a valid record.
+     */
+    inline bool validateVersionData() {
+        return findNewestSlot() != NO_SLOT;
+    }
+
+    /**
+     * @brief check to see if version data is stored at the end of the EEPROM.
+     * @return returns true iff a valid record exists (see validateVersionData())
      */
     inline bool dataIsWritten() {
-        uint16_t dataWrittenFlag = EEPROM.read(VERSION_DATA_START_ADDRESS);
-    return (dataWrittenFlag == DATA_EXISTS_MAGIC_NUMBER);
-}
+        return validateVersionData();
+    }
+
+    /**
+     * @brief A record about to be written into a slot, and the order its bytes are written in (the commit protocol).
+     * 
+     * The first byte of the record (the low byte of dataWritten) is the commit byte. It is cleared before
+     * anything else in the slot changes and written last, after the sequence number, the payload and the
+     * rest of the header. A reset at any point in between leaves the slot invalid rather than torn, and only
+     * the final single byte write (~3.3 ms) decides whether the new record exists. With SLOT_COUNT > 1 the
+     * slot being written is never the newest one, so readers always see either the old or the new record.
+     * 
+     * The slots hold records of one format at a time (see planRecord()). After the commit, every other slot that
+     * still holds a valid record of another format is uncommitted, one step per slot. Readers already ignore those
+     * (see findNewestSlot()); retiring them keeps the old format from coming back if the new record is lost later.
+     * Which slots to retire is decided by planRetire() before the first step, so no step runs a CRC.
+     * 
+     * writeRecord() writes the steps one after the other. The asynchronous writer (EEPROM_VC_Async.h) goes through
+     * the same steps a byte at a time. Backends that only write a RAM copy (see EEPROM_VC_Flash.h) are committed
+     * once the commit byte is written, and again if retiring changed anything, so a record costs one flash write.
+     */
+    struct recordWrite {
+        uint8_t slot;
+        uint16_t sequence;
+        recordHeader header;
+        ByteSource payload;
+        uint8_t retire[(SLOT_COUNT + 7) / 8];       // one bit per slot, set by planRetire()
+
+        static constexpr uint16_t COMMIT_STEP = 4;
+        static constexpr uint16_t STEP_COUNT = COMMIT_STEP + SLOT_COUNT;
+
+        /**
+         * @brief marks the other slots that hold a valid record of another format, to be uncommitted after the
+         * commit. Call once slot and header are set. The steps only write the slot they retire, so deciding before
+         * the write gives the same result as deciding in each step.
+         */
+        void planRetire() {
+            for (uint8_t other = 0; other < SLOT_COUNT; other++) {
+                const uint16_t otherMagic = storedMagic(other);
+                const bool retired = other != slot && otherMagic != header.dataWritten && slotIsValid(other, otherMagic);
+                if (retired) {
+                    retire[other / 8] |= static_cast<uint8_t>(1 << (other % 8));
+                } else {
+                    retire[other / 8] &= static_cast<uint8_t>(~(1 << (other % 8)));
+                }
+            }
+        }
+
+        /**
+         * @brief the block written by step `index` (0 <= index < STEP_COUNT). `length` is 0 if the step has nothing to do.
+         */
+        void step(uint16_t index, uint16_t &address, ByteSource &src, uint8_t &length) const {
+            const uint8_t *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+            address = recordAddress(slot);
+            src = ByteSource{headerBytes, false};
+            length = 1;
+            switch (index) {
+                case 0:     // uncommit, unless already uncommitted. Any other value may commit a record of some format.
+                    src = ByteSource{uncommittedMarker(), false};
+                    length = (Storage::read(address) != UNCOMMITTED_MARKER) ? 1 : 0;
+                    break;
+                case 1:
+                    address = slotAddress(slot);
+                    src = ByteSource{reinterpret_cast<const uint8_t *>(&sequence), false};
+                    length = SLOT_HEADER_BYTES;
+                    break;
+                case 2:
+                    address += RECORD_HEADER_BYTES;
+                    src = payload;
+                    length = header.recordLength;
+                    break;
+                case 3:
+                    address += 1;
+                    src = src + 1;
+                    length = sizeof(header) - 1;
+                    break;
+                case COMMIT_STEP:
+                    break;
+                default: {  // retire a record of another format in one of the other slots
+                    const uint8_t other = (slot + index - COMMIT_STEP) % SLOT_COUNT;
+                    address = recordAddress(other);
+                    src = ByteSource{uncommittedMarker(), false};
+                    length = (retire[other / 8] >> (other % 8)) & 1;
+                    break;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief writes a record with the given payload into a slot using the commit protocol (see recordWrite). If the
+     * backend reports a failed write, the steps after it, the commit byte included, are not written.
+     */
+    inline WriteResult writeRecord(const recordWrite &record) {
+        WriteResult result = {0, 0, false};
+        uint16_t committedBytes = 0;
+        for (uint16_t i = 0; i < recordWrite::STEP_COUNT; i++) {
+            uint16_t address;
+            ByteSource src;
+            uint8_t length;
+            record.step(i, address, src, length);
+            result += writeBlock(address, src, length);
+            if (result.failed) {
+                return result;      // never commit a record whose earlier steps didn't all make it
+            }
+            if ((i == recordWrite::COMMIT_STEP || i == recordWrite::STEP_COUNT - 1) && result.bytesWritten != committedBytes) {
+                result.failed = !backendCommit<Storage>(0);
+                committedBytes = result.bytesWritten;
+            }
+        }
+        return result;
+    }
+
+    inline WriteResult writeRecord(uint8_t slot, ByteSource payload, uint8_t payloadLength, uint16_t payloadCrc,
+                                   uint16_t sequence, uint16_t magic = DATA_EXISTS_MAGIC_NUMBER) {
+        recordWrite record = {slot, sequence, recordHeader{magic, LIBRARY_VERSION, payloadLength, payloadCrc}, payload, {}};
+        record.planRetire();
+        return writeRecord(record);
+    }
 
 
     /**
@@ -98,82 +784,320 @@ namespace EEPROMVersionControl {
      * It will overwrite existing data only if the `overwrite` parameter is set to `true` 
      * or if no data has been written yet.
      * 
+     * Only the bytes that differ from what is already stored are written, so rewriting the same
+     * metadata (e.g. reflashing a unit with unchanged version data) costs no EEPROM time or wear.
+     * With more than one slot, a changed record goes into the slot after the newest one, tagged with the
+     * next sequence number, so the writes are spread over all slots. See writeRecord() for the commit order.
+     * The fingerprint is computed from the values being written, whatever dataBlock.fingerprint holds.
+     * 
      * @param dataBlock The struct of type `versionData` containing the information to store.
      * @param overwrite Set to `true` to overwrite previously written data (default: `false`).
+     * @return the number of bytes written and the estimated EEPROM write time. Both are 0 if nothing changed.
+     *         `failed` is set if the backend reported a failed write; the record was then not committed.
+     */
+    EEPROM_VC_FUNCTION WriteResult writeDataToEEPROM(const versionData &dataBlock, bool overwrite = false);
+
+    /**
+     * @brief Writes the version data from CL_Version_Data.conf to EEPROM.
+     * 
+     * Same as writeDataToEEPROM(versionData(), overwrite), but the record is copied straight from the
+     * compile-time image in flash (ConfiguredRecord) and the change check compares flash against EEPROM,
+     * so no versionData struct is built in RAM and no constructor runs.
+     * 
+     * @param overwrite Set to `true` to overwrite previously written data (default: `false`).
+     * @return the number of bytes written and the estimated EEPROM write time. Both are 0 if nothing changed.
+     */
+    EEPROM_VC_FUNCTION WriteResult writeDataToEEPROM(bool overwrite = false);
+
+    /**
+     * @brief decides where a new record of the given format goes.
+     * 
+     * The slots hold one record format at a time. There is nothing to write if a record of any format already
+     * exists and `overwrite` is false, or the newest record is of this format and already holds exactly this
+     * payload. Otherwise the record goes into the slot after the newest one, with the next sequence number, and
+     * replaces the other format if there was one (see recordWrite).
+     * 
+     * @param record set to the record to write (untouched if there is nothing to write).
+     * @return `false` if there is nothing to write.
      */
-    void writeDataToEEPROM(const versionData &dataBlock, bool overwrite = false) {
-        if (!dataIsWritten() || overwrite) {
-            EEPROM.put(VERSION_DATA_START_ADDRESS, dataBlock);
+    inline bool planRecord(ByteSource payload, uint8_t payloadLength, uint16_t payloadCrc, bool overwrite, uint16_t magic,
+                           recordWrite &record) {
+        uint16_t sequence = 0;
+        uint16_t newestMagic = magic;
+        uint8_t newest = findNewestRecord(sequence, newestMagic);
+        if (newest != NO_SLOT) {
+            bool unchanged = newestMagic == magic
+                             && Storage::read(recordAddress(newest) + offsetof(recordHeader, recordLength)) == payloadLength
+                             && blockMatches(recordAddress(newest) + RECORD_HEADER_BYTES, payload, payloadLength);
+            if (!overwrite || unchanged) {
+                return false;       // nothing to do, or already the newest record
+            }
         }
+
+        record.slot = (newest == NO_SLOT) ? 0 : (newest + 1) % SLOT_COUNT;
+        record.sequence = (newest == NO_SLOT) ? 0 : sequence + 1;
+        record.header = recordHeader{magic, LIBRARY_VERSION, payloadLength, payloadCrc};
+        record.payload = payload;
+        record.planRetire();
+        return true;
+    }
+
+    /**
+     * @brief shared implementation of the writeDataToEEPROM() overloads and other record formats.
+     * 
+     * Writes the payload as a new record of the given format, unless planRecord() finds there is nothing to write.
+     */
+    inline WriteResult storeRecord(ByteSource payload, uint8_t payloadLength, uint16_t payloadCrc, bool overwrite,
+                                   uint16_t magic = DATA_EXISTS_MAGIC_NUMBER) {
+        recordWrite record;
+        if (!planRecord(payload, payloadLength, payloadCrc, overwrite, magic, record)) {
+            return WriteResult{0, 0, false};
+        }
+        return writeRecord(record);
     }
 
 
     /**
      * @brief Retrieves version data from EEPROM.
      * 
-     * This function reads the `versionData` struct from the reserved EEPROM space and 
+     * This function reads the newest `versionData` struct from the reserved EEPROM space and 
      * populates the provided `versionData` object.
      * 
      * @param storedData Reference to a `versionData` object where the retrieved data will be stored.
      * @return `true` if data was successfully retrieved, `false` if no valid data exists.
      */
-    bool getVersionData(versionData &storedData) {
-        if (dataIsWritten()) {
-            EEPROM.get(VERSION_DATA_START_ADDRESS, storedData);
-            return true;
+    EEPROM_VC_FUNCTION bool getVersionData(versionData &storedData);
+
+    ///////////////////////////////////////////////////////////////////////
+    // Boot-time fast path
+    ///////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief finds the newest committed slot from the slot headers alone: the payload CRC is not checked.
+     *
+     * A slot counts once its commit byte is written and its header names this library version, whatever the
+     * record format. That is 6 EEPROM reads with a single slot, and 8 per slot with more. A slot whose payload was
+     * corrupted after it was committed is still returned; findNewestSlot() is the validating lookup.
+     *
+     * @param header set to the header of the newest committed slot (untouched if there is none).
+     * @return the slot index, or NO_SLOT if no slot is committed.
+     */
+    inline uint8_t findNewestCommittedSlot(recordHeader &header) {
+        uint8_t newest = NO_SLOT;
+        uint16_t sequence = 0;
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            recordHeader slotHeader;
+            readBlock(recordAddress(slot), &slotHeader, sizeof(slotHeader));
+            if ((slotHeader.dataWritten & 0xFF) == UNCOMMITTED_MARKER
+                || slotHeader.libraryVersion != LIBRARY_VERSION
+                || slotHeader.recordLength > MAX_PAYLOAD_BYTES) {
+                continue;
+            }
+            uint16_t slotSequence = 0;
+            readBlock(slotAddress(slot), &slotSequence, SLOT_HEADER_BYTES);
+            if (newest == NO_SLOT || sequenceIsNewer(slotSequence, sequence)) {
+                newest = slot;
+                sequence = slotSequence;
+                header = slotHeader;
+            }
         }
-        return false;
+        return newest;
+    }
+
+    /**
+     * @brief true if the newest stored record holds the values from CL_Version_Data.conf.
+     *
+     * The header of the newest committed slot (see findNewestCommittedSlot()) is compared with the header of the
+     * compile-time image, which includes CONFIGURED_PAYLOAD_CRC, and the fingerprint stored with it with
+     * CONFIGURED_FINGERPRINT. No string is read: with a single slot this is 10 EEPROM reads. The commit protocol
+     * ensures a header is only present once the payload behind it is complete, so by default the payload CRC is
+     * not recomputed.
+     *
+     * @param checkCrc also run the payload CRC, so a record corrupted after it was committed is not taken for the
+     *                 configured one. This reads the whole payload (see validateVersionData()).
+     */
+    inline bool configuredDataIsStored(bool checkCrc = false) {
+        recordHeader header;
+        const uint8_t newest = findNewestCommittedSlot(header);
+        if (newest == NO_SLOT
+            || header.dataWritten != DATA_EXISTS_MAGIC_NUMBER
+            || header.recordLength != RECORD_PAYLOAD_BYTES
+            || header.crc != CONFIGURED_PAYLOAD_CRC) {
+            return false;
+        }
+        uint32_t fingerprint = 0;
+        readBlock(recordAddress(newest) + offsetof(versionData, fingerprint), &fingerprint, sizeof(fingerprint));
+        return fingerprint == CONFIGURED_FINGERPRINT && (!checkCrc || slotIsValid(newest));
+    }
+
+    /**
+     * @brief Makes sure the version data from CL_Version_Data.conf is stored. Meant to be called at every boot.
+     *
+     * Replaces the usual dataIsWritten() / getVersionData() / compare-the-strings / writeDataToEEPROM() sequence.
+     * The common case, where the EEPROM already holds this build's data, is decided by configuredDataIsStored()
+     * from the record header and the stored fingerprint. Otherwise the configured record is written from flash with
+     * writeDataToEEPROM(true), which only writes the bytes that differ.
+     *
+     * @param checkCrc also check the payload CRC, and rewrite a record corrupted after it was committed (see
+     *                 configuredDataIsStored()).
+     * @return the number of bytes written and the estimated EEPROM write time. Both are 0 if the data was up to date.
+     */
+    inline WriteResult ensureVersionStamped(bool checkCrc = false) {
+        if (configuredDataIsStored(checkCrc)) {
+            return WriteResult{0, 0, false};
+        }
+        return writeDataToEEPROM(true);
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // Single field accessors. These read one field straight from EEPROM,
+    // without a versionData struct in RAM.
+    ///////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief copies one string field of the newest valid record into `buffer`.
+     * 
+     * @param fieldOffset offsetof() the field in versionData.
+     * @param fieldSize sizeof() the field, including its null terminator.
+     * @param buffer destination, always null terminated on success. Truncated if it is shorter than the field.
+     * @param bufferSize size of `buffer` in bytes.
+     * @return `true` if the field was read, `false` if no valid data exists (buffer untouched).
+     */
+    inline bool readStringField(uint16_t fieldOffset, size_t fieldSize, char *buffer, size_t bufferSize) {
+        uint8_t newest = findNewestSlot();
+        if (newest == NO_SLOT || bufferSize == 0) {
+            return false;
+        }
+        size_t length = (bufferSize < fieldSize) ? bufferSize : fieldSize;
+        readBlock(recordAddress(newest) + fieldOffset, buffer, length - 1);
+        buffer[length - 1] = '\0';
+        return true;
+    }
+
+    /**
+     * @brief reads the projectName field of the stored version data. `buffer` should hold 21 bytes.
+     */
+    inline bool readProjectName(char *buffer, size_t bufferSize) {
+        return readStringField(offsetof(versionData, projectName), sizeof(versionData::projectName), buffer, bufferSize);
+    }
+
+    /**
+     * @brief reads the vendor field of the stored version data. `buffer` should hold 2 bytes.
+     */
+    inline bool readVendor(char *buffer, size_t bufferSize) {
+        return readStringField(offsetof(versionData, vendor), sizeof(versionData::vendor), buffer, bufferSize);
+    }
+
+    /**
+     * @brief reads the softwareVersion field of the stored version data. `buffer` should hold 8 bytes.
+     */
+    inline bool readSoftwareVersion(char *buffer, size_t bufferSize) {
+        return readStringField(offsetof(versionData, softwareVersion), sizeof(versionData::softwareVersion), buffer, bufferSize);
+    }
+
+    /**
+     * @brief reads the finalSoftwareDate field of the stored version data. `buffer` should hold 19 bytes.
+     */
+    inline bool readFinalSoftwareDate(char *buffer, size_t bufferSize) {
+        return readStringField(offsetof(versionData, finalSoftwareDate), sizeof(versionData::finalSoftwareDate), buffer, bufferSize);
+    }
+
+    /**
+     * @brief reads the projectVersion field of the stored version data.
+     * @return the project version, or 0 if no valid data exists (project versions start at 1).
+     */
+    inline uint8_t readProjectVersion() {
+        uint8_t newest = findNewestSlot();
+        if (newest == NO_SLOT) {
+            return 0;
+        }
+        return Storage::read(recordAddress(newest) + offsetof(versionData, projectVersion));
+    }
+
+    /**
+     * @brief reads the fingerprint (see versionFingerprint()) stored with the newest record.
+     *
+     * Compare the result with CONFIGURED_FINGERPRINT, or report it for inventory, instead of comparing five strings.
+     * Like configuredDataIsStored(), this reads the slot headers and then the 4 fingerprint bytes, without the
+     * payload CRC: 10 EEPROM reads with a single slot. Use validateVersionData() first if the record may have been
+     * corrupted after it was committed.
+     *
+     * @param fingerprint set to the fingerprint of the newest committed record (untouched if there is none).
+     * @return `false` if the newest committed record is not a versionData record, or there is none.
+     */
+    inline bool readFingerprint(uint32_t &fingerprint) {
+        recordHeader header;
+        const uint8_t newest = findNewestCommittedSlot(header);
+        if (newest == NO_SLOT
+            || header.dataWritten != DATA_EXISTS_MAGIC_NUMBER
+            || header.recordLength != RECORD_PAYLOAD_BYTES) {
+            return false;
+        }
+        readBlock(recordAddress(newest) + offsetof(versionData, fingerprint), &fingerprint, sizeof(fingerprint));
+        return true;
     }
 
     /**
      * @brief Retrieves the version number of this library (EEPROM_Version_Control.h) that was used to write data to EEPROM.
      * 
      * This is mainly provided in case we later change the fields of the versionData struct in some way that breaks
-     * compatibility with the setting and retrieving functions provided here.
+     * compatibility with the setting and retrieving functions provided here. It doesn't print anything; use
+     * printLibraryVersion() for that.
      * 
      * @param data Reference to a `versionData` object where the retrieved data is stored.
-     * @return the version numer of the library that wrote this data into the EEPROM.
+     * @return the version numer of the library that wrote this data into the EEPROM, or 0 if `data` holds no version data.
      */
-    uint8_t getLibraryVersion(const versionData &data) {
-        if (data.dataWritten == DATA_EXISTS_MAGIC_NUMBER) {
-            Serial.print("Library version: "); Serial.println(data.libraryVersion);
-        } else {
-            Serial.println("Version data does not exist.");
-        }
-        return data.libraryVersion;
+    inline uint8_t getLibraryVersion(const versionData &data) {
+        return (data.dataWritten == DATA_EXISTS_MAGIC_NUMBER) ? data.libraryVersion : 0;
     }
 
+    /**
+     * @brief Prints the library version that wrote `data`, or a message if `data` holds no version data.
+     * 
+     * @param data Reference to a `versionData` object where the retrieved data is stored.
+     * @param out where to print to (default: Serial).
+     */
+    EEPROM_VC_FUNCTION void printLibraryVersion(const versionData &data, Print &out = Serial);
+
 
     /**
-     * @brief Prints the version data to the Serial monitor.
+     * @brief Prints the version data to any Print sink (Serial by default).
      * 
      * This function prints the projectName, vendor name, project version, software version, 
-     * and final software date to the Serial monitor. If no data is available, 
+     * and final software date to `out`. If no data is available, 
      * it prints an appropriate message.
      * 
+     * Serial is only linked in if it is actually used, so sketches that report over SoftwareSerial, I2C, an
+     * LCD or a RAM buffer can pass their own Print object and skip HardwareSerial's buffers entirely.
+     * 
      * @param data Reference to the `versionData` struct containing the information to print.
+     * @param out where to print to (default: Serial).
      */
-    void printVersionData(const versionData &data) {
-        if (data.dataWritten == DATA_EXISTS_MAGIC_NUMBER) {
-            Serial.print(reinterpret_cast<const __FlashStringHelper *>(PRINT_PROJECT_NAME));
-            Serial.println(data.projectName);
-            
-            Serial.print(reinterpret_cast<const __FlashStringHelper *>(PRINT_VENDOR_NAME));
-            Serial.println(data.vendor);
-
-            Serial.print(reinterpret_cast<const __FlashStringHelper *>(PRINT_PROJECT_NAME_VERSION));
-            Serial.println(data.projectVersion);
+    EEPROM_VC_FUNCTION void printVersionData(const versionData &data, Print &out = Serial);
 
-            Serial.print(reinterpret_cast<const __FlashStringHelper *>(PRINT_SOFTWARE_VERSION));
-            Serial.println(data.softwareVersion);
-
-            Serial.print(reinterpret_cast<const __FlashStringHelper *>(PRINT_SOFTWARE_DATE));
-            Serial.println(data.finalSoftwareDate);
-        } else {
-            Serial.println("Version data does not exist.");
+    /**
+     * @brief prints one null terminated string field straight from EEPROM, one byte at a time.
+     */
+    inline void printStringFieldFromEEPROM(Print &out, uint16_t address, size_t fieldSize) {
+        for (size_t i = 0; i < fieldSize - 1; i++) {
+            uint8_t c = Storage::read(address + i);
+            if (c == '\0') break;
+            out.write(c);
         }
+        out.println();
     }
 
+    /**
+     * @brief Prints the stored version data without loading it into RAM.
+     * 
+     * Same output as printVersionData(), but each field is streamed byte by byte from the newest valid
+     * record in EEPROM into `out`, so no versionData struct is needed. Works with any Print sink
+     * (Serial, SoftwareSerial, an LCD, ...).
+     * 
+     * @param out where to print to (default: Serial).
+     */
+    EEPROM_VC_FUNCTION void printVersionDataFromEEPROM(Print &out = Serial);
+
     ///////////////////////////////////////////////////////////////////////
     // Setter functions for safely changing data field values
     ///////////////////////////////////////////////////////////////////////
@@ -189,6 +1113,7 @@ namespace EEPROMVersionControl {
     void setProjectName(versionData &data, const char (&newSKU)[N]) {
         static_assert(N <= 21, "Error in setProjectName: projectName exceeds maximum length of 20 characters.");
         safeStrCopy(data.projectName, newSKU, sizeof(data.projectName));
+        updateFingerprint(data);
     }
 
     /**
@@ -201,6 +1126,7 @@ namespace EEPROMVersionControl {
     void setVendor(versionData &data, const char (&newVendor)[N]) {
         static_assert(N <= 2, "Error in setVendor: Vendor name exceeds maximum length of 1 character.");
         safeStrCopy(data.vendor, newVendor, sizeof(data.vendor));
+        updateFingerprint(data);
     }
 
     /**
@@ -213,6 +1139,7 @@ namespace EEPROMVersionControl {
     void setSoftwareVersion(versionData &data, const char (&newVersion)[N]) {
         static_assert(N <= 8, "Error in setSoftwareVersion: Software version exceeds maximum length of 7 characters.");
         safeStrCopy(data.softwareVersion, newVersion, sizeof(data.softwareVersion));
+        updateFingerprint(data);
     }
 
     /**
@@ -225,6 +1152,7 @@ namespace EEPROMVersionControl {
     void setFinalSoftwareDate(versionData &data, const char (&newDate)[N]) {
         static_assert(N <= 19, "Error in setFinalSoftwareDate: Final software date exceeds maximum length of 18 characters.");
         safeStrCopy(data.finalSoftwareDate, newDate, sizeof(data.finalSoftwareDate));
+        updateFingerprint(data);
     }
 
     /**
@@ -233,9 +1161,94 @@ namespace EEPROMVersionControl {
      * @param data Reference to the `versionData` struct.
      * @param newVersion The new project version (must be greater than 0).
      */
-    void setProjectVersion(versionData &data, uint8_t newVersion) {
+    inline void setProjectVersion(versionData &data, uint8_t newVersion) {
         data.projectVersion = newVersion;
+        updateFingerprint(data);
     }
 }
 
+///////////////////////////////////////////////////////////////////////
+// Definitions of the EEPROM_VC_FUNCTION functions: inline in every file in the header-only mode, compiled once in
+// EEPROM_Version_Control.cpp (which defines EEPROM_VC_IMPLEMENTATION) with EEPROM_VC_COMPILED.
+///////////////////////////////////////////////////////////////////////
+
+#if !defined(EEPROM_VC_COMPILED) || defined(EEPROM_VC_IMPLEMENTATION)
+namespace EEPROMVersionControl {
+
+    EEPROM_VC_FUNCTION WriteResult writeDataToEEPROM(const versionData &dataBlock, bool overwrite) {
+        versionData record = dataBlock;     // the stored fingerprint is always that of the values written
+        updateFingerprint(record);
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(&record) + RECORD_HEADER_BYTES;
+        return storeRecord(ByteSource{payload, false}, RECORD_PAYLOAD_BYTES, crc16(payload, RECORD_PAYLOAD_BYTES), overwrite);
+    }
+
+    EEPROM_VC_FUNCTION WriteResult writeDataToEEPROM(bool overwrite) {
+        return storeRecord(ByteSource{ConfiguredRecord::bytes + RECORD_HEADER_BYTES, true}, RECORD_PAYLOAD_BYTES, CONFIGURED_PAYLOAD_CRC, overwrite);
+    }
+
+    EEPROM_VC_FUNCTION bool getVersionData(versionData &storedData) {
+        uint8_t newest = findNewestSlot();
+        if (newest != NO_SLOT) {
+            readBlock(recordAddress(newest), &storedData, RECORD_BYTES);
+            return true;
+        }
+        return false;
+    }
+
+    EEPROM_VC_FUNCTION void printLibraryVersion(const versionData &data, Print &out) {
+        if (data.dataWritten == DATA_EXISTS_MAGIC_NUMBER) {
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_LIBRARY_VERSION));
+            out.println(data.libraryVersion);
+        } else {
+            out.println(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_DATA_DNE));
+        }
+    }
+
+    EEPROM_VC_FUNCTION void printVersionData(const versionData &data, Print &out) {
+        if (data.dataWritten == DATA_EXISTS_MAGIC_NUMBER) {
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_PROJECT_NAME));
+            out.println(data.projectName);
+            
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_VENDOR_NAME));
+            out.println(data.vendor);
+
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_PROJECT_NAME_VERSION));
+            out.println(data.projectVersion);
+
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_SOFTWARE_VERSION));
+            out.println(data.softwareVersion);
+
+            out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_SOFTWARE_DATE));
+            out.println(data.finalSoftwareDate);
+        } else {
+            out.println(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_DATA_DNE));
+        }
+    }
+
+    EEPROM_VC_FUNCTION void printVersionDataFromEEPROM(Print &out) {
+        uint8_t newest = findNewestSlot();
+        if (newest == NO_SLOT) {
+            out.println(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_DATA_DNE));
+            return;
+        }
+        const uint16_t address = recordAddress(newest);
+
+        out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_PROJECT_NAME));
+        printStringFieldFromEEPROM(out, address + offsetof(versionData, projectName), sizeof(versionData::projectName));
+
+        out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_VENDOR_NAME));
+        printStringFieldFromEEPROM(out, address + offsetof(versionData, vendor), sizeof(versionData::vendor));
+
+        out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_PROJECT_NAME_VERSION));
+        out.println(Storage::read(address + offsetof(versionData, projectVersion)));
+
+        out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_SOFTWARE_VERSION));
+        printStringFieldFromEEPROM(out, address + offsetof(versionData, softwareVersion), sizeof(versionData::softwareVersion));
+
+        out.print(reinterpret_cast<const __FlashStringHelper *>(PrintStrings::PRINT_SOFTWARE_DATE));
+        printStringFieldFromEEPROM(out, address + offsetof(versionData, finalSoftwareDate), sizeof(versionData::finalSoftwareDate));
+    }
+}
+#endif
 
+#endif // EEPROM_VERSION_CONTROL_H
@@ -0,0 +1,33 @@
+/**
+ * Minimal checks for the host tests.
+ *
+ * CHECK(condition) prints the file and line of a failed condition and carries on, so one run reports every
+ * failure. main() returns checkFailures(), which ctest treats as a failed test when it isn't 0.
+ */
+
+#ifndef EEPROM_VC_TEST_CHECK_H
+#define EEPROM_VC_TEST_CHECK_H
+
+#include <stdio.h>
+
+inline int &checkFailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+inline int checkFailures() {
+    if (checkFailureCount() > 0) {
+        fprintf(stderr, "%d check(s) failed\n", checkFailureCount());
+    }
+    return checkFailureCount() > 0 ? 1 : 0;
+}
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            checkFailureCount()++;                                                  \
+        }                                                                           \
+    } while (0)
+
+#endif // EEPROM_VC_TEST_CHECK_H
@@ -0,0 +1,223 @@
+/**
+ * The asynchronous writer, against SimulatedEEPROM's ready timing. Built once polled from the "main loop" and once
+ * driven by the simulated ready interrupt (EEPROM_VC_ASYNC_INTERRUPT), see CMakeLists.txt.
+ */
+
+#include <EEPROM_VC_Async.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    const uint32_t LOOP_MICROS = 250;       // simulated time one pass of the sketch's loop() takes
+
+    bool sameFields(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    int completions = 0;
+    WriteResult completedResult = {0, 0, false};
+
+    void onComplete(const WriteResult &result) {
+        completions++;
+        completedResult = result;
+    }
+
+    SimulatedEEPROM *countedDevice = nullptr;
+    uint32_t mostReadsPerStep = 0;
+
+    void readyInterrupt() {
+        const uint32_t before = countedDevice ? countedDevice->bytesRead() : 0;
+        pollWrite();
+        if (countedDevice && countedDevice->bytesRead() - before > mostReadsPerStep) {
+            mostReadsPerStep = countedDevice->bytesRead() - before;
+        }
+    }
+
+    /**
+     * @brief runs the "main loop" until the write completes. In interrupt mode the loop doesn't poll.
+     * @return the number of loop passes.
+     */
+    uint32_t runUntilComplete(SimulatedEEPROM &device) {
+        uint32_t passes = 0;
+        while (!isWriteComplete() && passes < 100000) {
+            device.advance(LOOP_MICROS);
+            if (!ASYNC_WRITE_USES_INTERRUPT) pollWrite();
+            passes++;
+        }
+        return passes;
+    }
+
+    void testWriteInBackground() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        device.setReadyVector(readyInterrupt);
+        completions = 0;
+
+        CHECK(isWriteComplete());
+        CHECK(beginWriteVersionData(true, onComplete));
+        CHECK(!isWriteComplete() && !beginWriteVersionData(true));
+        CHECK(device.readyInterruptEnabled() == ASYNC_WRITE_USES_INTERRUPT);
+
+        // the loop keeps running: it is never held up by the EEPROM, and the record only appears once committed
+        versionData stored;
+        CHECK(!getVersionData(stored));
+        const uint32_t passes = runUntilComplete(device);
+        CHECK(isWriteComplete() && !device.readyInterruptEnabled());
+        CHECK(device.stalledMicros() == 0);
+        CHECK(passes * LOOP_MICROS >= device.bytesWritten() * SimulatedEEPROM::WRITE_TIME_US);
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+
+        // same bytes as the blocking writer, reported through the callback
+        CHECK(completions == 1);
+        CHECK(completedResult.bytesWritten == device.bytesWritten() && completedResult.estimatedMicros == device.elapsedMicros());
+        SimulatedEEPROM blocking;
+        SimulatedEEPROM::attach(blocking);
+        CHECK(writeDataToEEPROM(true).bytesWritten == completedResult.bytesWritten);
+        CHECK(blocking.stalledMicros() > 0);
+        SimulatedEEPROM::attach(device);
+
+        // unchanged data completes at once
+        CHECK(beginWriteVersionData(true, onComplete) && isWriteComplete());
+        CHECK(completions == 2 && completedResult.bytesWritten == 0);
+    }
+
+    void testUpdateKeepsOldRecordReadable() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        device.setReadyVector(readyInterrupt);
+        writeDataToEEPROM(true);
+        device.advance(SimulatedEEPROM::WRITE_TIME_US);
+
+        static versionData changed;         // must outlive the write
+        setSoftwareVersion(changed, "1.0.0.1");
+        // the record is written straight from the struct, so a fingerprint the setters didn't update is refused
+        changed.softwareVersion[6] = '2';
+        CHECK(!beginWriteVersionData(changed, true) && isWriteComplete());
+        changed.softwareVersion[6] = '1';
+        CHECK(beginWriteVersionData(changed, true));
+        versionData stored;
+        while (!isWriteComplete()) {
+            device.advance(LOOP_MICROS);
+            if (!ASYNC_WRITE_USES_INTERRUPT) pollWrite();
+            // a reader in the loop sees the old record or none (single slot), never a mix
+            const bool valid = getVersionData(stored);
+            CHECK(!valid || sameFields(stored, versionData()) || sameFields(stored, changed));
+            if (SLOT_COUNT > 1) CHECK(valid);
+        }
+        CHECK(getVersionData(stored) && sameFields(stored, changed));
+    }
+
+    // the records to retire are chosen when the write starts, so no step (in interrupt mode, no run of the
+    // handler) checks the CRC of another slot: each reads a few bytes at most
+    void testStepsRunNoCrc() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        device.setReadyVector(readyInterrupt);
+        const uint16_t OTHER_MAGIC = 99;
+        uint8_t other[40];
+        memset(other, 0x5A, sizeof(other));
+        storeRecord(ByteSource{other, false}, sizeof(other), crc16(other, sizeof(other)), true, OTHER_MAGIC);
+        uint16_t sequence = 0;
+        const uint8_t otherSlot = findNewestSlot(sequence, OTHER_MAGIC);
+        CHECK(otherSlot != NO_SLOT);
+        device.advance(SimulatedEEPROM::WRITE_TIME_US);
+
+        CHECK(beginWriteVersionData(true));
+        countedDevice = &device;
+        mostReadsPerStep = 0;
+        for (uint32_t passes = 0; !isWriteComplete() && passes < 100000; passes++) {
+            device.advance(LOOP_MICROS);
+            if (!ASYNC_WRITE_USES_INTERRUPT) readyInterrupt();
+        }
+        countedDevice = nullptr;
+        CHECK(isWriteComplete() && mostReadsPerStep > 0 && mostReadsPerStep < sizeof(other));
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+        if (SLOT_COUNT > 1) CHECK(Storage::read(recordAddress(otherSlot)) == UNCOMMITTED_MARKER);
+    }
+
+    void testServiceBudget() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        device.setReadyVector(readyInterrupt);
+        const uint16_t budget = 2 * SimulatedEEPROM::WRITE_TIME_US;
+
+        CHECK(service(budget) == 0 && remainingWriteBytes() == 0);
+        CHECK(beginWriteVersionData(true));
+        const uint16_t total = remainingWriteBytes();       // the count includes a byte that is being written
+        CHECK(total >= RECORD_PAYLOAD_BYTES);
+
+        // each pass writes at most 1 + budget / WRITE_TIME_US bytes and never stalls for longer than the budget
+        uint32_t passes = 0;
+        uint16_t remaining = remainingWriteBytes();
+        while (!isWriteComplete() && passes < 100000) {
+            device.advance(LOOP_MICROS);
+            const uint64_t stalled = device.stalledMicros();
+            const uint32_t written = device.bytesWritten();
+            const uint16_t left = service(budget);
+            CHECK(device.stalledMicros() - stalled <= budget);
+            CHECK(device.bytesWritten() - written <= 1 + budget / SimulatedEEPROM::WRITE_TIME_US);
+            CHECK(left <= remaining && left == remainingWriteBytes());
+            const uint32_t writing = (device.bytesWritten() > 0 && !isWriteComplete()) ? 1 : 0;
+            CHECK(left + device.bytesWritten() == total + writing && (left > 0 || isWriteComplete()));
+            remaining = left;
+            passes++;
+        }
+        CHECK(isWriteComplete() && remainingWriteBytes() == 0);
+        CHECK(device.bytesWritten() == total && asyncWriteProgress().bytesWritten == total);
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+
+        // a bigger budget takes fewer passes than polling once per pass would
+        if (!ASYNC_WRITE_USES_INTERRUPT) CHECK(passes * LOOP_MICROS < total * SimulatedEEPROM::WRITE_TIME_US);
+
+        // the count matches what the blocking writer writes, also when only a field changes
+        static versionData changed;
+        setSoftwareVersion(changed, "1.0.0.2");
+        device.advance(SimulatedEEPROM::WRITE_TIME_US);
+        CHECK(beginWriteVersionData(changed, true));
+        const uint16_t expected = remainingWriteBytes();
+        while (!isWriteComplete()) {
+            device.advance(LOOP_MICROS);
+            service(0);
+        }
+        CHECK(asyncWriteProgress().bytesWritten == expected);
+        CHECK(getVersionData(stored) && sameFields(stored, changed));
+    }
+
+    // service() only returns 0 once the commit byte has finished writing, so power can be cut right then
+    void testCutWhenServiceReturnsZero() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        device.setReadyVector(readyInterrupt);
+        writeDataToEEPROM(true);
+        device.advance(SimulatedEEPROM::WRITE_TIME_US);
+
+        static versionData changed;
+        setSoftwareVersion(changed, "1.0.0.3");
+        CHECK(beginWriteVersionData(changed, true));
+        uint32_t passes = 0;
+        while (service(0) > 0 && passes < 100000) {
+            device.advance(LOOP_MICROS);
+            passes++;
+        }
+        CHECK(isWriteComplete() && device.ready());
+        device.cutPower();
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, changed));
+    }
+}
+
+int main() {
+    testWriteInBackground();
+    testUpdateKeepsOldRecordReadable();
+    testStepsRunNoCrc();
+    testServiceBudget();
+    testCutWhenServiceReturnsZero();
+    return checkFailures();
+}
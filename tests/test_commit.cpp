@@ -0,0 +1,280 @@
+/**
+ * Writing and reading records. Built once per storage configuration (single slot, wear leveling ring, A/B
+ * atomic updates), see CMakeLists.txt.
+ */
+
+#include <EEPROM_Version_Control.h>
+#include "check.h"
+
+#include <string.h>
+#include <string>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    bool sameFields(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    struct BufferPrint : public Print {
+        std::string text;
+        size_t write(uint8_t c) override {
+            text += static_cast<char>(c);
+            return 1;
+        }
+        using Print::write;
+    };
+
+    versionData updated() {
+        versionData data;
+        setSoftwareVersion(data, "2.1.0.7");
+        setFinalSoftwareDate(data, "March 3, 2026");
+        setProjectVersion(data, 2);
+        return data;
+    }
+
+    void testRoundTrip() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored;
+        CHECK(!getVersionData(stored) && !dataIsWritten());
+
+        WriteResult result = writeDataToEEPROM(versionData());
+        CHECK(result.bytesWritten == device.bytesWritten());
+        CHECK(result.estimatedMicros == device.elapsedMicros());
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+
+        // identical data and an existing record without overwrite cost nothing
+        CHECK(writeDataToEEPROM(versionData(), true).bytesWritten == 0);
+        CHECK(writeDataToEEPROM(updated()).bytesWritten == 0);
+
+        result = writeDataToEEPROM(updated(), true);
+        CHECK(result.bytesWritten > 0);
+        CHECK(getVersionData(stored) && sameFields(stored, updated()));
+
+        // the boot-time check only rewrites a record that differs from CL_Version_Data.conf
+        CHECK(!configuredDataIsStored());
+        CHECK(ensureVersionStamped().bytesWritten > 0 && configuredDataIsStored());
+        CHECK(ensureVersionStamped().bytesWritten == 0);
+    }
+
+    // ensureVersionStamped() writes the configured record, then skips while its header and fingerprint match, and
+    // with checkCrc also repairs it once its payload no longer matches its CRC
+    void testEnsureVersionStamped() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        CHECK(!configuredDataIsStored());
+        CHECK(ensureVersionStamped().bytesWritten > 0 && configuredDataIsStored());
+        device.resetStats();
+        CHECK(ensureVersionStamped().bytesWritten == 0 && device.bytesWritten() == 0);
+        CHECK(device.bytesRead() <= (RECORD_HEADER_BYTES + SLOT_HEADER_BYTES) * SLOT_COUNT + sizeof(uint32_t));
+
+        // a flipped payload byte behind an intact header is only noticed by the CRC
+        const uint16_t damaged = recordAddress(findNewestSlot()) + offsetof(versionData, softwareVersion);
+        device.write(damaged, device.read(damaged) ^ 0x01);
+        CHECK(configuredDataIsStored() && !configuredDataIsStored(true));
+        CHECK(ensureVersionStamped().bytesWritten == 0);
+        CHECK(ensureVersionStamped(true).bytesWritten > 0 && configuredDataIsStored(true));
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+        CHECK(ensureVersionStamped(true).bytesWritten == 0);
+
+        // a stored fingerprint that differs is noticed without the CRC
+        const uint16_t stale = recordAddress(findNewestSlot()) + offsetof(versionData, fingerprint);
+        device.write(stale, device.read(stale) ^ 0x01);
+        CHECK(!configuredDataIsStored());
+        CHECK(ensureVersionStamped().bytesWritten > 0 && configuredDataIsStored(true));
+    }
+
+    void testFlashImage() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        // the compile-time record for the conf values is the same record a default versionData produces
+        CHECK(writeDataToEEPROM(true).bytesWritten > 0);
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+        CHECK(writeDataToEEPROM(versionData(), true).bytesWritten == 0);
+
+        writeDataToEEPROM(updated(), true);
+        CHECK(writeDataToEEPROM().bytesWritten == 0);
+        CHECK(writeDataToEEPROM(true).bytesWritten > 0);
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+    }
+
+    void testFingerprint() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        static_assert(CONFIGURED_FINGERPRINT == versionFingerprint(PROJECT_NAME, VENDOR, PROJECT_VERSION, SOFTWARE_VERSION, SOFTWARE_DATE),
+                      "the configured fingerprint is a compile-time constant");
+        CHECK(versionFingerprint(versionData()) == CONFIGURED_FINGERPRINT);
+        CHECK(versionFingerprint(updated()) != CONFIGURED_FINGERPRINT);
+        // FNV-1a of "a\0b\0" + 1 + "c\0d\0", as a tool would compute it
+        CHECK(versionFingerprint("a", "b", 1, "c", "d") == 0xA085EF72UL);
+
+        uint32_t fingerprint = 0;
+        CHECK(!readFingerprint(fingerprint));
+        writeDataToEEPROM(true);
+        device.resetStats();
+        CHECK(readFingerprint(fingerprint) && fingerprint == CONFIGURED_FINGERPRINT);
+        CHECK(device.bytesRead() <= (RECORD_HEADER_BYTES + SLOT_HEADER_BYTES) * SLOT_COUNT + sizeof(fingerprint));
+        writeDataToEEPROM(updated(), true);
+        CHECK(readFingerprint(fingerprint) && fingerprint == versionFingerprint(updated()));
+
+        // the fingerprint is stored with the record, and kept current by the setters and by writeDataToEEPROM()
+        CHECK(fingerprintIsCurrent(versionData()) && storedFingerprint(versionData()) == CONFIGURED_FINGERPRINT);
+        CHECK(fingerprintIsCurrent(updated()));
+        versionData stale = updated();
+        stale.softwareVersion[0] = '3';
+        CHECK(!fingerprintIsCurrent(stale));
+        writeDataToEEPROM(stale, true);
+        versionData stored;
+        CHECK(getVersionData(stored) && fingerprintIsCurrent(stored) && strcmp(stored.softwareVersion, "3.1.0.7") == 0);
+        CHECK(readFingerprint(fingerprint) && fingerprint == versionFingerprint(stale));
+    }
+
+    void testFieldAccessors() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        char buffer[21];
+        CHECK(!readProjectName(buffer, sizeof(buffer)) && readProjectVersion() == 0);
+
+        writeDataToEEPROM(updated(), true);
+        CHECK(readSoftwareVersion(buffer, sizeof(buffer)) && strcmp(buffer, "2.1.0.7") == 0);
+        CHECK(readFinalSoftwareDate(buffer, sizeof(buffer)) && strcmp(buffer, "March 3, 2026") == 0);
+        CHECK(readProjectVersion() == 2);
+        // a short buffer gets a truncated, terminated copy
+        CHECK(readFinalSoftwareDate(buffer, 6) && strcmp(buffer, "March") == 0);
+    }
+
+    void testPrintFromEEPROM() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        BufferPrint empty;
+        printVersionDataFromEEPROM(empty);
+        CHECK(empty.text == "Version data does not exist.\r\n");
+
+        writeDataToEEPROM(updated(), true);
+        BufferPrint out;
+        printVersionDataFromEEPROM(out);
+        CHECK(out.text.find("Software Version: 2.1.0.7\r\n") != std::string::npos);
+        CHECK(out.text.find("March 3, 2026\r\n") != std::string::npos);
+
+        // printing a record loaded into RAM gives the same text
+        versionData stored;
+        CHECK(getVersionData(stored) && getLibraryVersion(stored) == LIBRARY_VERSION);
+        BufferPrint fromRam;
+        printVersionData(stored, fromRam);
+        CHECK(fromRam.text == out.text);
+    }
+
+    void testPlacement() {
+        SimulatedEEPROM device;
+        CHECK(device.size() == EEPROM_SIZE_BYTES);
+        CHECK(VERSION_DATA_END_ADDRESS <= EEPROM_SIZE_BYTES);
+        if (VERSION_DATA_BASE_ADDRESS != AUTO_PLACEMENT) {
+            CHECK(VERSION_DATA_REGION_START == VERSION_DATA_BASE_ADDRESS);
+        } else if (Geometry::PAGE_BYTES == 1 && Geometry::ERASE_BYTES == 1) {
+            CHECK(VERSION_DATA_END_ADDRESS == EEPROM_SIZE_BYTES - 1);     // where library version 1 put it
+        }
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            CHECK(slotAddress(slot) % Geometry::PAGE_BYTES == 0);
+        }
+    }
+
+    void testRingRotates() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        for (uint8_t i = 0; i < 2 * SLOT_COUNT; i++) {
+            writeDataToEEPROM((i % 2) ? updated() : versionData(), true);
+            CHECK(findNewestSlot() == i % SLOT_COUNT);
+        }
+        // each slot was written twice, so no cell more than twice per write (the commit byte is cleared and set)
+        CHECK(device.maxWear() <= 2 * 2);
+    }
+
+    // Cuts the power after every possible number of byte writes of an update: the reader must see either the old
+    // or the new record, never a mix, and with a second slot the old record must survive any cut.
+    void testTornWrites(const versionData &before, const versionData &after) {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeDataToEEPROM(before, true);
+        SimulatedEEPROM prepared = device;
+        device.resetStats();
+        const uint32_t fullWrite = writeDataToEEPROM(after, true).bytesWritten;
+        CHECK(fullWrite > 0);
+
+        for (uint32_t cut = 0; cut <= fullWrite; cut++) {
+            SimulatedEEPROM torn = prepared;
+            SimulatedEEPROM::attach(torn);
+            torn.resetStats();
+            torn.setWriteLimit(cut);
+            writeDataToEEPROM(after, true);
+            torn.setWriteLimit(UINT32_MAX);
+
+            versionData stored;
+            const bool valid = getVersionData(stored);
+            CHECK(!valid || sameFields(stored, before) || sameFields(stored, after));
+            if (cut == fullWrite) {
+                CHECK(valid && sameFields(stored, after));
+            } else if (SLOT_COUNT > 1) {
+                CHECK(valid && sameFields(stored, before));
+            }
+
+            // the next update after power returns goes through
+            writeDataToEEPROM(after, true);
+            CHECK(getVersionData(stored) && sameFields(stored, after));
+        }
+        SimulatedEEPROM::attach(device);
+    }
+
+    // A slot holding a committed record of another format (e.g. TLV) is uncommitted before it is overwritten, so a
+    // cut can't leave the new header and payload behind the other format's commit byte. Once the new record is
+    // committed, the other format's records in the remaining slots are uncommitted too.
+    void testOtherFormatTornWrites() {
+        const uint16_t otherMagic = DATA_EXISTS_MAGIC_NUMBER + 1;
+        uint8_t otherPayload[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            otherPayload[0] = slot;
+            storeRecord(ByteSource{otherPayload, false}, sizeof(otherPayload), crc16(otherPayload, sizeof(otherPayload)), true, otherMagic);
+            CHECK(slotIsValid(slot, otherMagic));
+        }
+        SimulatedEEPROM prepared = device;
+        device.resetStats();
+        const uint32_t fullWrite = writeDataToEEPROM(true).bytesWritten;
+        CHECK(fullWrite > 0 && findNewestSlot() == 0);
+        for (uint8_t slot = 0; slot < SLOT_COUNT; slot++) {
+            CHECK(!slotIsValid(slot, otherMagic));
+        }
+
+        for (uint32_t cut = 1; cut < fullWrite; cut++) {
+            SimulatedEEPROM torn = prepared;
+            SimulatedEEPROM::attach(torn);
+            torn.resetStats();
+            torn.setWriteLimit(cut);
+            writeDataToEEPROM(true);
+            versionData stored;
+            CHECK(!slotIsValid(0, otherMagic));
+            CHECK(!getVersionData(stored) || sameFields(stored, versionData()));
+        }
+        SimulatedEEPROM::attach(device);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testEnsureVersionStamped();
+    testFlashImage();
+    testFingerprint();
+    testFieldAccessors();
+    testPrintFromEEPROM();
+    testPlacement();
+    testRingRotates();
+    testTornWrites(versionData(), updated());
+    testOtherFormatTornWrites();
+    testTornWrites(updated(), versionData());
+    return checkFailures();
+}
@@ -0,0 +1,124 @@
+/**
+ * ExternalEEPROMBackend against SimulatedI2CEEPROM, a 24LC256 model. Built once with a single slot and once with
+ * the wear leveling ring, see CMakeLists.txt.
+ */
+
+#define EEPROM_VC_GEOMETRY EEPROMVersionControl::EEPROM24LC256Geometry
+#define EEPROM_VC_BACKEND EEPROMVersionControl::ExternalEEPROMBackend<EEPROMVersionControl::SimulatedI2CEEPROM>
+#include <EEPROM_VC_External.h>
+#include <EEPROM_Version_Control.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    typedef ExternalEEPROMBackend<SimulatedI2CEEPROM> Backend;
+
+    bool sameFields(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    void testDeviceModel() {
+        SimulatedI2CEEPROM device;
+        Backend::attach(device);
+        CHECK(device.size() == 32768 && Backend::MAX_BURST_BYTES == 30);
+
+        // a burst that runs past the end of a page wraps around to its start, like the real part
+        const uint8_t bytes[4] = {1, 2, 3, 4};
+        device.beginTransmission(I2C_EEPROM_DEVICE_ADDRESS);
+        device.write(0x00);
+        device.write(62);
+        device.write(bytes, sizeof(bytes));
+        CHECK(device.endTransmission() == 0);
+        CHECK(device.busy() && device.wrappedWrites() == 1);
+        CHECK(device.peek(62) == 1 && device.peek(63) == 2 && device.peek(0) == 3 && device.peek(64) == 0xFF);
+
+        // the part NACKs until the write cycle is over, and ACK polling waits exactly that long
+        CHECK(device.requestFrom(I2C_EEPROM_DEVICE_ADDRESS, 1) == 0);
+        CHECK(Backend::waitUntilReady() && !device.busy());
+        CHECK(device.acknowledgePolls() > 1);
+        CHECK(Backend::read(63) == 2);
+
+        // a different device address is never acknowledged
+        device.beginTransmission(I2C_EEPROM_DEVICE_ADDRESS + 1);
+        CHECK(device.endTransmission() == 2);
+    }
+
+    void testPageBursts() {
+        SimulatedI2CEEPROM device;
+        Backend::attach(device);
+        WriteResult result = writeDataToEEPROM(true);
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+
+        // every write cycle is one page burst, none crossed a page, and a record takes a handful of cycles
+        // where byte writes would take one per byte
+        CHECK(device.pageWrites() == result.estimatedMicros / Backend::WRITE_TIME_US);
+        CHECK(device.bytesWritten() == result.bytesWritten);
+        CHECK(device.wrappedWrites() == 0);
+        CHECK(device.pageWrites() <= 6 && result.bytesWritten >= RECORD_PAYLOAD_BYTES);
+        CHECK(!device.busy());
+
+        // unchanged data costs nothing, a changed field costs a burst or two plus the commit
+        const uint32_t pageWrites = device.pageWrites();
+        CHECK(writeDataToEEPROM(true).bytesWritten == 0 && device.pageWrites() == pageWrites);
+
+        versionData changed;
+        setSoftwareVersion(changed, "1.0.0.1");
+        writeDataToEEPROM(changed, true);
+        CHECK(getVersionData(stored) && sameFields(stored, changed));
+        CHECK(device.wrappedWrites() == 0);
+        CHECK(ensureVersionStamped().bytesWritten > 0 && configuredDataIsStored());
+    }
+
+    // a part that isn't there: nothing is written, and the result says so
+    void testDetachedPart() {
+        SimulatedI2CEEPROM device(32768, 64, I2C_EEPROM_DEVICE_ADDRESS + 1);
+        Backend::attach(device);
+        const WriteResult result = writeDataToEEPROM(true);
+        CHECK(result.failed && result.bytesWritten == 0 && device.bytesWritten() == 0);
+        CHECK(!Backend::waitUntilReady() && !dataIsWritten());
+    }
+
+    // a burst the part refuses stops the record write before its commit byte, wherever it happens
+    void testRefusedBurst() {
+        SimulatedI2CEEPROM device;
+        Backend::attach(device);
+        writeDataToEEPROM(true);
+        const SimulatedI2CEEPROM prepared = device;
+        versionData changed;
+        setSoftwareVersion(changed, "1.0.0.1");
+        const uint32_t bursts = device.pageWrites();
+        CHECK(!writeDataToEEPROM(changed, true).failed);
+        const uint32_t fullWrite = device.pageWrites() - bursts;
+
+        for (uint32_t cut = 0; cut < fullWrite; cut++) {
+            SimulatedI2CEEPROM refusing = prepared;
+            Backend::attach(refusing);
+            refusing.refuseWriteAfter(cut);
+            const WriteResult result = writeDataToEEPROM(changed, true);
+            CHECK(result.failed && refusing.refusedWrites() == 1);
+            CHECK(refusing.pageWrites() == bursts + cut);       // nothing after the refused burst
+
+            // the new record was never committed: the old one is still read, unless the only slot was cleared
+            versionData stored;
+            const bool valid = getVersionData(stored);
+            CHECK(valid ? sameFields(stored, versionData()) : (SLOT_COUNT == 1 && cut > 0));
+
+            CHECK(!writeDataToEEPROM(changed, true).failed);
+            CHECK(getVersionData(stored) && sameFields(stored, changed));
+        }
+    }
+}
+
+int main() {
+    testDeviceModel();
+    testPageBursts();
+    testDetachedPart();
+    testRefusedBurst();
+    return checkFailures();
+}
@@ -0,0 +1,91 @@
+/**
+ * FlashEEPROMBackend against SimulatedFlashEEPROM, an EEPROM library that emulates EEPROM in flash with a RAM copy.
+ * Built once with a single slot and once with the wear leveling ring, see CMakeLists.txt.
+ */
+
+#define EEPROM_VC_GEOMETRY EEPROMVersionControl::emulatedEEPROMGeometry<1024, 256, 8000>
+#define EEPROM_VC_BACKEND EEPROMVersionControl::FlashEEPROMBackend<EEPROMVersionControl::SimulatedFlashEEPROM>
+#include <EEPROM_VC_Flash.h>
+#include <EEPROM_VC_Async.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    typedef FlashEEPROMBackend<SimulatedFlashEEPROM> Backend;
+
+    bool sameFields(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    // a reset: the RAM copy is lost, and setup() attaches the backend again
+    void restart(SimulatedFlashEEPROM &device) {
+        device.reset();
+        Backend::attach(device);
+    }
+
+    void testCommitPerRecord() {
+        SimulatedFlashEEPROM device;
+        Backend::attach(device);
+        CHECK(device.begins() == 1 && device.commits() == 0);
+        CHECK(!dataIsWritten());
+
+        // the record reaches flash in one commit, and survives a reset
+        CHECK(writeDataToEEPROM(true).bytesWritten > 0);
+        CHECK(device.commits() == 1 && device.sectorWrites() <= 2);
+        restart(device);
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+
+        // unchanged data commits nothing, a changed record commits once
+        CHECK(writeDataToEEPROM(true).bytesWritten == 0 && ensureVersionStamped().bytesWritten == 0);
+        CHECK(device.commits() == 1);
+        versionData changed;
+        setSoftwareVersion(changed, "1.0.0.1");
+        writeDataToEEPROM(changed, true);
+        CHECK(device.commits() == 2);
+        restart(device);
+        CHECK(getVersionData(stored) && sameFields(stored, changed));
+        CHECK(device.begins() == 3);
+    }
+
+    // a reset before the commit loses the whole write, so flash still holds the old record
+    void testLostCommit() {
+        SimulatedFlashEEPROM device;
+        Backend::attach(device);
+        writeDataToEEPROM(true);
+        versionData changed;
+        setSoftwareVersion(changed, "1.0.0.1");
+        device.setCommitLimit(0);
+        const WriteResult result = writeDataToEEPROM(changed, true);
+        CHECK(result.bytesWritten > 0 && result.failed);
+        restart(device);
+        device.setCommitLimit(UINT32_MAX);
+        versionData stored;
+        CHECK(getVersionData(stored) && sameFields(stored, versionData()));
+    }
+
+    // the asynchronous writer commits once the record is complete
+    void testAsyncCommit() {
+        SimulatedFlashEEPROM device;
+        Backend::attach(device);
+        CHECK(beginWriteVersionData(true));
+        while (pollWrite()) {
+            CHECK(device.commits() == 0);
+        }
+        CHECK(isWriteComplete() && device.commits() == 1);
+        restart(device);
+        CHECK(configuredDataIsStored());
+    }
+}
+
+int main() {
+    testCommitPerRecord();
+    testLostCommit();
+    testAsyncCommit();
+    return checkFailures();
+}
@@ -0,0 +1,67 @@
+# Runs eeprom_vc_fleet (extras/tools) over a directory of dumps made with eeprom_vc_image, plus a unit still holding
+# a record of library version 1 (v1_record.eep), and checks the aggregates, with one worker thread and with several.
+# Run by ctest:
+#
+#     cmake -D IMAGE_TOOL=<eeprom_vc_image> -D FLEET_TOOL=<eeprom_vc_fleet> -D WORK_DIR=<scratch directory> -P test_fleet_tool.cmake
+
+set(dumps ${WORK_DIR}/dumps)
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${dumps})
+
+function(encode file)
+    execute_process(COMMAND ${IMAGE_TOOL} encode ${ARGN} ${dumps}/${file} RESULT_VARIABLE failed)
+    if(failed)
+        message(FATAL_ERROR "eeprom_vc_image encode ${ARGN} failed")
+    endif()
+endfunction()
+
+foreach(unit 1 2 3)
+    encode(unit${unit}.bin --raw)
+endforeach()
+encode(unit4.eep)
+encode(unit5.eep --vendor N --software-version 1.1.0.0)
+encode(unit6.eep --name "Tank, \"Plant\"" --software-version 2.0.0.0)
+file(COPY ${CMAKE_CURRENT_LIST_DIR}/v1_record.eep DESTINATION ${dumps})
+file(WRITE ${dumps}/erased.eep ":00000001FF\n")
+file(WRITE ${dumps}/notes.txt "not a dump\n")
+
+set(expected_json "{\"files\":9,\"status\":{\"empty\":1,\"unreadable\":1,\"valid\":7},\"library_versions\":{\"1\":1,\"2\":6},\"versions\":[\
+{\"project_name\":\"Old Unit\",\"vendor\":\"M\",\"project_version\":1,\"software_version\":\"0.9.0.0\",\"units\":1},\
+{\"project_name\":\"Sand Garden\",\"vendor\":\"M\",\"project_version\":1,\"software_version\":\"1.0.0.0\",\"units\":4},\
+{\"project_name\":\"Sand Garden\",\"vendor\":\"N\",\"project_version\":1,\"software_version\":\"1.1.0.0\",\"units\":1},\
+{\"project_name\":\"Tank, \\\"Plant\\\"\",\"vendor\":\"M\",\"project_version\":1,\"software_version\":\"2.0.0.0\",\"units\":1}]}\n")
+
+foreach(jobs 1 4)
+    execute_process(COMMAND ${FLEET_TOOL} --jobs ${jobs} --json --units ${WORK_DIR}/units.csv ${dumps}
+                    RESULT_VARIABLE result OUTPUT_VARIABLE json)
+    if(NOT result EQUAL 0 OR NOT json STREQUAL expected_json)
+        message(SEND_ERROR "--jobs ${jobs}: exit ${result}, got\n${json}expected\n${expected_json}")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${FLEET_TOOL} ${dumps} OUTPUT_VARIABLE csv)
+set(expected_csv "project_name,vendor,project_version,software_version,units
+\"Old Unit\",\"M\",1,\"0.9.0.0\",1
+\"Sand Garden\",\"M\",1,\"1.0.0.0\",4
+\"Sand Garden\",\"N\",1,\"1.1.0.0\",1
+\"Tank, \"\"Plant\"\"\",\"M\",1,\"2.0.0.0\",1
+")
+if(NOT csv STREQUAL expected_csv)
+    message(SEND_ERROR "got\n${csv}expected\n${expected_csv}")
+endif()
+
+file(READ ${WORK_DIR}/units.csv units)
+foreach(line
+        "\"erased.eep\",empty,,,,,,,,,\"\""
+        "\"notes.txt\",unreadable,,,,,,,,,\"raw dump is 11 bytes, expected [0-9]+\""
+        "\"unit5.eep\",valid,2,0,\"Sand Garden\",\"N\",1,\"1.1.0.0\",\"January 15, 2025\",0x[0-9A-F]+,"
+        "\"v1_record.eep\",valid,1,,\"Old Unit\",\"M\",1,\"0.9.0.0\",\"June 2, 2023\",0x[0-9A-F]+,")
+    if(NOT units MATCHES "\n${line}\n")
+        message(SEND_ERROR "no line matching ${line} in\n${units}")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${FLEET_TOOL} ${WORK_DIR}/missing RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+if(NOT result EQUAL 2)
+    message(SEND_ERROR "a missing directory exited with ${result}")
+endif()
@@ -0,0 +1,201 @@
+/**
+ * The version history log (EEPROM_VC_History.h): walking back through appended versions, wrapping the log,
+ * changes split over several entries, torn appends and plain writes. Built with VERSION_HISTORY_DEPTH > 0, see
+ * CMakeLists.txt.
+ */
+
+#include <EEPROM_VC_History.h>
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace EEPROMVersionControl;
+
+static_assert(VERSION_HISTORY_DEPTH >= 4, "test_history needs a history variant of CL_Version_Data.conf");
+
+namespace {
+
+    bool samePayload(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    // a small change: one character of the software version, one history entry
+    versionData release(uint8_t build) {
+        versionData data;
+        char version[8];
+        snprintf(version, sizeof(version), "1.0.%u", build);
+        safeStrCopy(data.softwareVersion, version, sizeof(data.softwareVersion));
+        updateFingerprint(data);
+        return data;
+    }
+
+    // a change too big for one entry
+    versionData renamed() {
+        versionData data = release(0);
+        safeStrCopy(data.projectName, "Zyxwvutsrqponmlkjihg", sizeof(data.projectName));
+        updateFingerprint(data);
+        return data;
+    }
+
+    // walks the history and checks it is `versions` newest first: all of them, or the newest `expected`
+    void checkWalk(const std::vector<versionData> &versions, size_t expected) {
+        versionHistoryIterator history;
+        versionData data;
+        size_t walked = 0;
+        while (history.next(data)) {
+            CHECK(walked < versions.size() && samePayload(data, versions[versions.size() - 1 - walked]));
+            CHECK(history.steps() == walked);
+            walked++;
+        }
+        CHECK(walked == expected);
+    }
+
+    uint8_t storedHistoryEntries() {
+        uint8_t count = 0;
+        historyEntryHeader header;
+        for (uint8_t entry = 0; entry < VERSION_HISTORY_DEPTH; entry++) {
+            if (readHistoryEntry(entry, header)) count++;
+        }
+        return count;
+    }
+
+    void testWalkBack() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        std::vector<versionData> versions;
+        bool recorded = true;
+        versions.push_back(release(0));
+        writeDataToEEPROMWithHistory(versions.back(), &recorded);
+        CHECK(!recorded);       // nothing stored before, so nothing to keep
+
+        for (uint8_t build = 1; build < VERSION_HISTORY_DEPTH; build++) {
+            versions.push_back(release(build));
+            CHECK(writeDataToEEPROMWithHistory(versions.back(), &recorded).bytesWritten > 0 && recorded);
+        }
+        CHECK(storedHistoryEntries() == VERSION_HISTORY_DEPTH - 1);
+        checkWalk(versions, versions.size());
+
+        // the configured data, straight from flash
+        versions.push_back(versionData());
+        CHECK(writeDataToEEPROMWithHistory(&recorded).bytesWritten > 0 && recorded);
+        checkWalk(versions, versions.size());
+    }
+
+    // once the log is full, each new version overwrites the oldest entry
+    void testWrap() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        std::vector<versionData> versions;
+        for (uint8_t build = 0; build < 2 * VERSION_HISTORY_DEPTH + 3; build++) {
+            versions.push_back(release(build));
+            writeDataToEEPROMWithHistory(versions.back());
+            checkWalk(versions, (build < VERSION_HISTORY_DEPTH) ? build + 1 : VERSION_HISTORY_DEPTH + 1);
+        }
+    }
+
+    // a change that needs several entries is applied as one step back
+    void testSplitEntry() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        std::vector<versionData> versions;
+        versions.push_back(release(0));
+        writeDataToEEPROMWithHistory(versions.back());
+        versions.push_back(renamed());
+        bool recorded = false;
+        writeDataToEEPROMWithHistory(versions.back(), &recorded);
+        CHECK(recorded);
+
+        uint8_t entries = storedHistoryEntries();
+        bool continued = false;
+        historyEntryHeader header;
+        for (uint8_t entry = 0; entry < VERSION_HISTORY_DEPTH; entry++) {
+            if (readHistoryEntry(entry, header) && (header.length & HISTORY_CONTINUED)) continued = true;
+        }
+        CHECK(entries > 1 && continued);
+        checkWalk(versions, 2);
+
+        versions.push_back(release(1));
+        writeDataToEEPROMWithHistory(versions.back());
+        checkWalk(versions, 3);
+    }
+
+    // a cut anywhere in an append leaves a walk that is a true suffix of the history: it never yields a version
+    // that was never stored
+    void testTornAppend() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        std::vector<versionData> versions;
+        versions.push_back(release(0));
+        writeDataToEEPROMWithHistory(versions.back());
+        versions.push_back(release(1));
+        writeDataToEEPROMWithHistory(versions.back());
+        SimulatedEEPROM prepared = device;
+
+        for (const versionData &next : {release(2), renamed()}) {
+            SimulatedEEPROM full = prepared;
+            SimulatedEEPROM::attach(full);
+            full.resetStats();
+            const uint32_t fullWrite = writeDataToEEPROMWithHistory(next).bytesWritten;
+            CHECK(fullWrite > 0);
+
+            for (uint32_t cut = 1; cut < fullWrite; cut++) {
+                SimulatedEEPROM torn = prepared;
+                SimulatedEEPROM::attach(torn);
+                torn.resetStats();
+                torn.setWriteLimit(cut);
+                writeDataToEEPROMWithHistory(next);
+
+                std::vector<versionData> expected = versions;
+                versionHistoryIterator history;
+                versionData data;
+                if (!history.next(data)) {
+                    CHECK(SLOT_COUNT == 1);     // a single slot loses the record while it is rewritten
+                    continue;
+                }
+                if (samePayload(data, next)) expected.push_back(next);
+                size_t walked = 1;
+                CHECK(samePayload(data, expected.back()));
+                while (history.next(data)) {
+                    CHECK(walked < expected.size() && samePayload(data, expected[expected.size() - 1 - walked]));
+                    walked++;
+                }
+            }
+        }
+        SimulatedEEPROM::attach(device);
+    }
+
+    // writeDataToEEPROM() replaces the record without an entry; the walk then stops at the current record
+    void testPlainWrite() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeDataToEEPROMWithHistory(release(0));
+        writeDataToEEPROMWithHistory(release(1));
+        const uint8_t entries = storedHistoryEntries();
+        uint16_t sequence = 0;
+        const uint8_t newest = findNewestHistoryEntry(sequence);
+
+        std::vector<versionData> versions;
+        versions.push_back(release(2));
+        writeDataToEEPROM(versions.back(), true);
+        uint16_t sequenceAfter = 0;
+        CHECK(storedHistoryEntries() == entries && findNewestHistoryEntry(sequenceAfter) == newest && sequenceAfter == sequence);
+        checkWalk(versions, 1);
+
+        // appending again starts a new chain from the current record
+        versions.push_back(release(3));
+        writeDataToEEPROMWithHistory(versions.back());
+        checkWalk(versions, 2);
+    }
+}
+
+int main() {
+    testWalkBack();
+    testWrap();
+    testSplitEntry();
+    testTornAppend();
+    testPlainWrite();
+    return checkFailures();
+}
@@ -0,0 +1,93 @@
+# Round trips through eeprom_vc_image (extras/tools): an encoded .eep and raw image decode to the same values, a
+# record of library version 1 (v1_record.eep, for an ATmega328P) is decoded, a corrupted byte is reported, and bad
+# input is rejected. Run by ctest:
+#
+#     cmake -D TOOL=<eeprom_vc_image> -D WORK_DIR=<scratch directory> -P test_image_tool.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# run(<expected exit code> <output variable> <arguments>...)
+function(run expected output)
+    execute_process(COMMAND ${TOOL} ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    if(NOT result EQUAL expected)
+        message(SEND_ERROR "eeprom_vc_image ${ARGN} exited with ${result}, expected ${expected}\n${out}${err}")
+    endif()
+    set(${output} "${out}${err}" PARENT_SCOPE)
+endfunction()
+
+function(expect output pattern)
+    if(NOT output MATCHES "${pattern}")
+        message(SEND_ERROR "expected \"${pattern}\" in:\n${output}")
+    endif()
+endfunction()
+
+# the values from CL_Version_Data.conf, as Intel HEX
+run(0 out encode ${WORK_DIR}/conf.eep)
+file(READ ${WORK_DIR}/conf.eep hex)
+string(REGEX MATCHALL "[^\n]+" lines "${hex}")         # not file(STRINGS), which turns Intel HEX into binary
+list(GET lines -1 last)
+expect("${last}" "^:00000001FF$")
+run(0 out decode ${WORK_DIR}/conf.eep)
+expect("${out}" "project name: +Sand Garden\n")
+expect("${out}" "software version: +1\\.0\\.0\\.0\n")
+expect("${out}" "library version: +[0-9]+\n")
+
+# overridden values, as a raw image
+run(0 out encode --name "Tank Plant" --vendor N --project-version 2 --software-version 2.1.0.7
+                 --date "March 7, 2025" --raw ${WORK_DIR}/custom.bin)
+run(0 out decode ${WORK_DIR}/custom.bin)
+expect("${out}" "project name: +Tank Plant\n")
+expect("${out}" "vendor: +N\n")
+expect("${out}" "project version: +2\n")
+expect("${out}" "software version: +2\\.1\\.0\\.7\n")
+expect("${out}" "software date: +March 7, 2025\n")
+
+# a unit still holding a record of library version 1 is decoded, and the version reported
+run(0 out decode ${CMAKE_CURRENT_LIST_DIR}/v1_record.eep)
+expect("${out}" "library version 1 layout")
+expect("${out}" "library version: +1\n")
+expect("${out}" "project name: +Old Unit\n")
+expect("${out}" "software version: +0\\.9\\.0\\.0\n")
+expect("${out}" "software date: +June 2, 2023\n")
+
+# a broken line is rejected
+string(REPLACE "53616E64" "53616E65" broken "${hex}")      # "Sand" -> "Sane", line checksum left as it was
+file(WRITE ${WORK_DIR}/bad_checksum.eep "${broken}")
+run(2 out decode ${WORK_DIR}/bad_checksum.eep)
+expect("${out}" "line 1: bad checksum")
+
+# the same change with a correct line checksum is a well formed file, but the record's CRC catches it
+list(GET lines 0 first)
+string(REPLACE "53616E64" "53616E65" first "${first}")
+string(LENGTH "${first}" length)
+math(EXPR last_byte "${length} - 4")
+set(sum 0)
+foreach(i RANGE 1 ${last_byte} 2)
+    string(SUBSTRING "${first}" ${i} 2 byte)
+    math(EXPR sum "(${sum} + 0x${byte}) & 0xFF")
+endforeach()
+math(EXPR checksum "(256 - ${sum}) & 0xFF" OUTPUT_FORMAT HEXADECIMAL)
+math(EXPR cut "${length} - 2")
+string(SUBSTRING "${first}" 0 ${cut} first)
+string(SUBSTRING "${checksum}" 2 -1 checksum)
+string(LENGTH "${checksum}" digits)
+if(digits LESS 2)
+    set(checksum "0${checksum}")
+endif()
+string(TOUPPER "${first}${checksum}" first)
+list(REMOVE_AT lines 0)
+list(INSERT lines 0 "${first}")
+string(REPLACE ";" "\n" fixed "${lines}")
+file(WRITE ${WORK_DIR}/bad_crc.eep "${fixed}\n")
+run(1 out decode ${WORK_DIR}/bad_crc.eep)
+expect("${out}" "slot 0 at 0x[0-9A-F]+: bad CRC\n")
+
+# an erased EEPROM has no record, and bad input is rejected
+file(WRITE ${WORK_DIR}/erased.eep ":00000001FF\n")
+run(1 out decode ${WORK_DIR}/erased.eep)
+expect("${out}" ": empty\n")
+run(2 out decode ${WORK_DIR}/missing.eep)
+run(2 out encode --name "A project name that is far too long" ${WORK_DIR}/long.eep)
+expect("${out}" "longer than 20 characters")
+run(2 out frobnicate)
@@ -0,0 +1,135 @@
+/**
+ * Reading and upgrading records of older library versions (EEPROM_VC_Migration.h). Built once per storage
+ * configuration, see CMakeLists.txt: with one slot the current record overlaps the version 1 area, with a ring or
+ * a placed region it usually doesn't.
+ */
+
+#include <EEPROM_VC_Migration.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    versionDataV1 v1Record() {
+        versionDataV1 record;
+        memset(&record, 0, sizeof(record));
+        record.dataWritten = DATA_EXISTS_MAGIC_NUMBER;
+        record.libraryVersion = 1;
+        strcpy(record.projectName, "Tank Plant");
+        strcpy(record.vendor, "N");
+        record.projectVersion = 3;
+        strcpy(record.softwareVersion, "0.9.1");
+        strcpy(record.finalSoftwareDate, "September 23, 2024");
+        return record;
+    }
+
+    // a version 1 image at the address version 1 wrote to
+    void storeV1(const versionDataV1 &record) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&record);
+        for (uint16_t i = 0; i < sizeof(record); i++) {
+            Storage::write(V1_RECORD_ADDRESS + i, bytes[i]);
+        }
+    }
+
+    bool matchesV1(const versionData &data, const versionDataV1 &record) {
+        return strcmp(data.projectName, record.projectName) == 0 && strcmp(data.vendor, record.vendor) == 0
+               && data.projectVersion == record.projectVersion && strcmp(data.softwareVersion, record.softwareVersion) == 0
+               && strcmp(data.finalSoftwareDate, record.finalSoftwareDate) == 0;
+    }
+
+    void testDecodeV1() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored;
+        CHECK(getMigratedVersionData(stored) == 0);
+
+        storeV1(v1Record());
+        CHECK(!getVersionData(stored));
+        CHECK(getMigratedVersionData(stored) == 1);
+        CHECK(matchesV1(stored, v1Record()) && getLibraryVersion(stored) == 1);
+        CHECK(fingerprintIsCurrent(stored));        // version 1 stored none, so it is computed from the values
+    }
+
+    void testMigrate() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        storeV1(v1Record());
+
+        uint8_t fromVersion = 0;
+        WriteResult result = migrateVersionData(&fromVersion);
+        CHECK(fromVersion == 1 && result.bytesWritten > 0);
+        versionData stored;
+        CHECK(getVersionData(stored) && matchesV1(stored, v1Record()));
+        uint32_t fingerprint = 0;
+        CHECK(readFingerprint(fingerprint) && fingerprint == versionFingerprint(stored));
+
+        // from now on the current record is the one read, and migrating again does nothing
+        CHECK(getMigratedVersionData(stored) == LIBRARY_VERSION && matchesV1(stored, v1Record()));
+        result = migrateVersionData(&fromVersion);
+        CHECK(fromVersion == LIBRARY_VERSION && result.bytesWritten == 0);
+    }
+
+    // version 1 had no CRC: anything that isn't a plausible record is refused
+    void testRejectCorruptV1() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored;
+
+        versionDataV1 unterminated = v1Record();
+        memset(unterminated.softwareVersion, '9', sizeof(unterminated.softwareVersion));
+        storeV1(unterminated);
+        CHECK(getMigratedVersionData(stored) == 0);
+        uint8_t fromVersion = 0xFF;
+        CHECK(migrateVersionData(&fromVersion).bytesWritten == 0 && fromVersion == 0);
+
+        versionDataV1 unterminatedName = v1Record();
+        memset(unterminatedName.projectName, 'x', sizeof(unterminatedName.projectName));
+        storeV1(unterminatedName);
+        CHECK(getMigratedVersionData(stored) == 0);
+
+        versionDataV1 otherVersion = v1Record();
+        otherVersion.libraryVersion = 7;
+        storeV1(otherVersion);
+        CHECK(getMigratedVersionData(stored) == 0);
+
+        versionDataV1 badMagic = v1Record();
+        badMagic.dataWritten = DATA_EXISTS_MAGIC_NUMBER + 0x100;
+        storeV1(badMagic);
+        CHECK(getMigratedVersionData(stored) == 0);
+    }
+
+    // a current record is read in preference to a version 1 record left in EEPROM next to it
+    void testCurrentRecordWins() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeDataToEEPROM();
+        const uint16_t current = recordAddress(findNewestSlot());
+        const bool shared = V1_RECORD_ADDRESS < current + RECORD_BYTES && current < V1_RECORD_ADDRESS + sizeof(versionDataV1);
+        versionData stored;
+        if (!shared) {
+            storeV1(v1Record());
+            CHECK(getMigratedVersionData(stored) == LIBRARY_VERSION);
+            CHECK(strcmp(stored.projectName, PROJECT_NAME) == 0 && strcmp(stored.softwareVersion, SOFTWARE_VERSION) == 0);
+            CHECK(migrateVersionData().bytesWritten == 0);
+        }
+
+        // a current record written over (or next to) a version 1 image
+        SimulatedEEPROM upgraded;
+        SimulatedEEPROM::attach(upgraded);
+        storeV1(v1Record());
+        writeDataToEEPROM(true);
+        CHECK(getMigratedVersionData(stored) == LIBRARY_VERSION && strcmp(stored.projectName, PROJECT_NAME) == 0);
+        CHECK(migrateVersionData().bytesWritten == 0);
+    }
+}
+
+int main() {
+    testDecodeV1();
+    testMigrate();
+    testRejectCorruptV1();
+    testCurrentRecordWins();
+    return checkFailures();
+}
@@ -0,0 +1,138 @@
+/**
+ * Packed records (EEPROM_VC_Packed.h): only values that read back exactly are accepted, dates over the whole
+ * range, and a stored record that doesn't decode leaves the caller's data alone. See CMakeLists.txt.
+ */
+
+#include <EEPROM_VC_Packed.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    versionData withVersion(const char *softwareVersion) {
+        versionData data;
+        safeStrCopy(data.softwareVersion, softwareVersion, sizeof(data.softwareVersion));
+        return data;
+    }
+
+    versionData withDate(const char *date) {
+        versionData data;
+        safeStrCopy(data.finalSoftwareDate, date, sizeof(data.finalSoftwareDate));
+        return data;
+    }
+
+    bool sameText(const versionData &a, const versionData &b) {
+        return strcmp(a.projectName, b.projectName) == 0 && strcmp(a.vendor, b.vendor) == 0
+               && a.projectVersion == b.projectVersion && strcmp(a.softwareVersion, b.softwareVersion) == 0
+               && strcmp(a.finalSoftwareDate, b.finalSoftwareDate) == 0;
+    }
+
+    // packs, writes and reads back `data` on a blank device
+    bool roundTrips(const versionData &data) {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored;
+        return writePackedDataToEEPROM(data) && getPackedVersionData(stored) && sameText(stored, data)
+               && getLibraryVersion(stored) == LIBRARY_VERSION;
+    }
+
+    // rejected values write nothing
+    bool rejected(const versionData &data) {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        packedRecord record;
+        return !packVersionData(data, record) && !writePackedDataToEEPROM(data) && device.bytesWritten() == 0;
+    }
+
+    void testRoundTrip() {
+        CHECK(roundTrips(versionData()));
+        CHECK(roundTrips(withVersion("0")));
+        CHECK(roundTrips(withVersion("10.0.255")));
+        CHECK(roundTrips(withVersion("1.0.0.0")));
+        CHECK(roundTrips(withVersion("1.2.3.4")));
+        CHECK(roundTrips(withDate("September 23, 2024")));
+
+        versionData named;
+        safeStrCopy(named.projectName, "Tank Plant-2 v3", sizeof(named.projectName));
+        safeStrCopy(named.vendor, "N", sizeof(named.vendor));
+        CHECK(roundTrips(named));
+    }
+
+    void testRejectsLossyValues() {
+        CHECK(rejected(withVersion("01.2")));
+        CHECK(rejected(withVersion("1.02")));
+        CHECK(rejected(withVersion("1.2.")));
+        CHECK(rejected(withVersion("1..2")));
+        CHECK(rejected(withVersion(".1")));
+        CHECK(rejected(withVersion("")));
+        CHECK(rejected(withVersion("256")));
+        CHECK(rejected(withVersion("1.2a")));
+
+        CHECK(rejected(withDate("Jan 15, 2025")));
+        CHECK(rejected(withDate("Janu 15, 2025")));
+        CHECK(rejected(withDate("january 15, 2025")));
+        CHECK(rejected(withDate("January 05, 2025")));
+        CHECK(rejected(withDate("January 005, 2025")));
+        CHECK(rejected(withDate("January 0015, 2025")));
+        CHECK(rejected(withDate("January 15,2025")));
+        CHECK(rejected(withDate("January 15, 25")));
+
+        versionData named;
+        safeStrCopy(named.projectName, "Tank_Plant", sizeof(named.projectName));
+        CHECK(rejected(named));
+    }
+
+    void testDateRange() {
+        CHECK(roundTrips(withDate("January 1, 2000")));
+        CHECK(roundTrips(withDate("February 29, 2000")));       // divisible by 400: a leap year
+        CHECK(roundTrips(withDate("February 29, 2024")));
+        CHECK(roundTrips(withDate("December 31, 2178")));
+        CHECK(roundTrips(withDate("June 6, 2179")));            // day 0xFFFF, the last one that fits
+
+        CHECK(rejected(withDate("February 29, 2023")));
+        CHECK(rejected(withDate("February 29, 2100")));         // divisible by 100 only: not a leap year
+        CHECK(rejected(withDate("February 30, 2024")));
+        CHECK(rejected(withDate("April 31, 2024")));
+        CHECK(rejected(withDate("January 0, 2024")));
+        CHECK(rejected(withDate("December 31, 1999")));
+        CHECK(rejected(withDate("June 7, 2179")));
+
+        uint16_t days = 0;
+        char formatted[19];
+        CHECK(parsePackedDate("January 1, 2000", days) && days == 0);
+        CHECK(parsePackedDate("June 6, 2179", days) && days == 0xFFFF);
+        formatPackedDate(0xFFFF, formatted, sizeof(formatted));
+        CHECK(strcmp(formatted, "June 6, 2179") == 0);
+    }
+
+    // a valid record whose payload doesn't decode is refused, and the caller's versionData isn't touched
+    void testUndecodableRecord() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored = withVersion("9.9");
+        CHECK(!getPackedVersionData(stored));
+
+        const uint8_t noComponents[] = {0, 0, 1, 0, 0, 0};     // empty name and vendor, version 1, 0 components
+        storeRecord(ByteSource{noComponents, false}, sizeof(noComponents), crc16(noComponents, sizeof(noComponents)), true,
+                    PACKED_MAGIC_NUMBER);
+        CHECK(validatePackedData() && !getPackedVersionData(stored));
+        CHECK(strcmp(stored.softwareVersion, "9.9") == 0);
+
+        const uint8_t truncated[] = {0, 0, 1, 2, 1};           // two components announced, one stored, no date
+        storeRecord(ByteSource{truncated, false}, sizeof(truncated), crc16(truncated, sizeof(truncated)), true,
+                    PACKED_MAGIC_NUMBER);
+        CHECK(validatePackedData() && !getPackedVersionData(stored));
+        CHECK(strcmp(stored.softwareVersion, "9.9") == 0 && strcmp(stored.projectName, PROJECT_NAME) == 0);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testRejectsLossyValues();
+    testDateRange();
+    testUndecodableRecord();
+    return checkFailures();
+}
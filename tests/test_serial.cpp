@@ -0,0 +1,139 @@
+/**
+ * The binary version query: reply frames through an in-memory loopback, and a full query from the host client
+ * (extras/tools/serial_port.h) to a unit stand-in on a pseudo terminal. Built with the wear leveling ring, so the
+ * reply has to come from the newest slot, see CMakeLists.txt.
+ */
+
+#include <EEPROM_VC_Serial.h>
+#include "serial_port.h"
+#include "check.h"
+
+#include <string.h>
+#include <string>
+#include <thread>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    bool sameFields(const versionData &a, const versionData &b) {
+        return memcmp(reinterpret_cast<const uint8_t *>(&a) + RECORD_HEADER_BYTES,
+                      reinterpret_cast<const uint8_t *>(&b) + RECORD_HEADER_BYTES, RECORD_PAYLOAD_BYTES) == 0;
+    }
+
+    struct BufferPrint : public Print {
+        std::string bytes;
+        size_t write(uint8_t c) override {
+            bytes += static_cast<char>(c);
+            return 1;
+        }
+        using Print::write;
+    };
+
+    // stands in for Serial: what the tester sent, and what the sketch answered
+    struct LoopbackPort : public BufferPrint {
+        std::string input;
+        int available() { return static_cast<int>(input.size()); }
+        int read() {
+            if (input.empty()) return -1;
+            uint8_t c = input[0];
+            input.erase(0, 1);
+            return c;
+        }
+    };
+
+    /**
+     * @brief feeds `frame` to a parser up to the first final state.
+     */
+    versionReplyParser::state parse(const std::string &frame, versionData &data) {
+        versionReplyParser parser;
+        versionReplyParser::state state = versionReplyParser::WAITING;
+        for (char c : frame) {
+            state = parser.feed(static_cast<uint8_t>(c));
+            if (state != versionReplyParser::WAITING && state != versionReplyParser::RECEIVING) break;
+        }
+        if (state == versionReplyParser::RECORD_RECEIVED) parser.record(data);
+        return state;
+    }
+
+    void testLoopback() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData data;
+
+        // no record yet: a short frame saying so
+        LoopbackPort port;
+        CHECK(!serviceVersionQuery(port));
+        port.input = "x";
+        CHECK(!serviceVersionQuery(port) && port.bytes.empty());
+        port.input = std::string(1, static_cast<char>(VERSION_QUERY_REQUEST));
+        CHECK(serviceVersionQuery(port));
+        CHECK(port.bytes.size() == VERSION_REPLY_OVERHEAD_BYTES);
+        CHECK(parse(port.bytes, data) == versionReplyParser::NO_RECORD_RECEIVED);
+
+        // the newest record, byte for byte as stored, after text the sketch printed earlier
+        writeDataToEEPROM(true);
+        versionData changed;
+        setSoftwareVersion(changed, "1.0.0.9");
+        writeDataToEEPROM(changed, true);
+        BufferPrint reply;
+        CHECK(!handleVersionQuery('?', reply) && handleVersionQuery(VERSION_QUERY_REQUEST, reply));
+        CHECK(reply.bytes.size() == RECORD_BYTES + VERSION_REPLY_OVERHEAD_BYTES);
+        CHECK(parse("Software Version: 1.0.0.0\r\n" + reply.bytes, data) == versionReplyParser::RECORD_RECEIVED);
+        CHECK(sameFields(data, changed));
+        CHECK(parse(std::string(1, static_cast<char>(VERSION_REPLY_SYNC)) + reply.bytes, data) == versionReplyParser::RECORD_RECEIVED);
+
+        // a flipped bit anywhere after the sync byte is caught
+        for (size_t i = 1; i < reply.bytes.size(); i++) {
+            std::string corrupted = reply.bytes;
+            corrupted[i] ^= 0x10;
+            versionReplyParser::state state = parse(corrupted, data);
+            CHECK(state == versionReplyParser::FRAME_ERROR);
+        }
+
+        // a frame that is intact but carries a bad record (wrong payload CRC, frame CRC fixed up)
+        std::string forged = reply.bytes.substr(0, reply.bytes.size() - 2);
+        forged[3 + RECORD_HEADER_BYTES] ^= 0x01;
+        uint16_t crc = CRC16_INITIAL_VALUE;
+        for (size_t i = 1; i < forged.size(); i++) crc = crc16Update(crc, static_cast<uint8_t>(forged[i]));
+        forged += static_cast<char>(crc & 0xFF);
+        forged += static_cast<char>(crc >> 8);
+        CHECK(parse(forged, data) == versionReplyParser::RECORD_ERROR);
+    }
+
+    void testPseudoTerminal() {
+        int controller;
+        std::string deviceName, error;
+        if (!openPseudoTerminal(controller, deviceName, error)) {
+            fprintf(stderr, "no pseudo terminal (%s), skipping\n", error.c_str());
+            return;
+        }
+        int tester = openSerialPort(deviceName.c_str(), 115200, error);
+        CHECK(tester >= 0);
+
+        // the "unit" runs on its own thread with its own EEPROM, like the firmware on the other end of a cable
+        std::thread unit([controller]() {
+            SimulatedEEPROM device;
+            SimulatedEEPROM::attach(device);
+            writeDataToEEPROM(true);
+            serveVersionQueries(controller, 500);
+        });
+        versionData data;
+        CHECK(queryVersion(tester, 2000, data, error) == versionReplyParser::RECORD_RECEIVED);
+        CHECK(sameFields(data, versionData()));
+        // and again on the same connection
+        CHECK(queryVersion(tester, 2000, data, error) == versionReplyParser::RECORD_RECEIVED);
+        unit.join();
+
+        // nobody answering times out
+        CHECK(queryVersion(tester, 100, data, error) == versionReplyParser::WAITING && !error.empty());
+        close(tester);
+        close(controller);
+    }
+}
+
+int main() {
+    testLoopback();
+    testPseudoTerminal();
+    return checkFailures();
+}
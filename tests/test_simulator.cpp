@@ -0,0 +1,85 @@
+/**
+ * SimulatedEEPROM and SimulatedEEPROMBackend: the host model everything else is tested and benchmarked on.
+ */
+
+#include <EEPROM_Version_Control.h>
+#include "check.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    void testErasedAndWear() {
+        SimulatedEEPROM device(1024);
+        CHECK(device.size() == 1024);
+        CHECK(device.read(0) == 0xFF && device.read(1023) == 0xFF);
+
+        device.write(10, 0x42);
+        device.write(10, 0x43);
+        CHECK(device.read(10) == 0x43);
+        CHECK(device.wear(10) == 2 && device.wear(11) == 0);
+        CHECK(device.maxWear() == 2 && device.maxWear(11, 100) == 0);
+        CHECK(device.bytesWritten() == 2 && device.bytesRead() == 3);
+
+        device.erase();
+        CHECK(device.read(10) == 0xFF && device.wear(10) == 0 && device.bytesWritten() == 0);
+    }
+
+    void testTiming() {
+        SimulatedEEPROM device(1024);
+        device.write(0, 1);
+        CHECK(device.elapsedMicros() == SimulatedEEPROM::WRITE_TIME_US);
+        device.write(1, 2);
+        CHECK(device.elapsedMicros() == 2 * SimulatedEEPROM::WRITE_TIME_US);
+        device.read(1);             // reads are free
+        CHECK(device.elapsedMicros() == 2 * SimulatedEEPROM::WRITE_TIME_US);
+
+        device.resetStats();
+        CHECK(device.elapsedMicros() == 0 && device.bytesWritten() == 0 && device.wear(0) == 1);
+    }
+
+    void testImages() {
+        SimulatedEEPROM device(1024);
+        device.write(5, 0x55);
+        char path[] = "/tmp/eeprom_vc_test_XXXXXX";
+        int fd = mkstemp(path);
+        CHECK(fd >= 0);
+        if (fd < 0) return;
+        close(fd);
+        CHECK(device.saveImage(path));
+
+        SimulatedEEPROM copy(1024);
+        CHECK(copy.loadImage(path));
+        CHECK(copy.read(5) == 0x55 && copy.read(4) == 0xFF && copy.bytesWritten() == 0);
+        remove(path);
+    }
+
+    void testBackend() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        CHECK(&SimulatedEEPROM::active() == &device);
+        Storage::write(3, 0x33);
+        CHECK(device.read(3) == 0x33 && Storage::read(3) == 0x33);
+        CHECK(device.bytesWritten() == 1 && device.elapsedMicros() == Storage::WRITE_TIME_US);
+
+        // the library's diff writer goes through the backend and estimates the simulated time
+        device.resetStats();
+        const uint8_t block[4] = {0x33, 1, 2, 3};
+        WriteResult result = writeBlock(3, block, sizeof(block));
+        CHECK(result.bytesWritten == 3);
+        CHECK(result.estimatedMicros == 3 * Storage::WRITE_TIME_US);
+        CHECK(device.bytesWritten() == 3 && device.elapsedMicros() == result.estimatedMicros);
+        CHECK(writeBlock(3, block, sizeof(block)).bytesWritten == 0);
+    }
+}
+
+int main() {
+    testErasedAndWear();
+    testTiming();
+    testImages();
+    testBackend();
+    return checkFailures();
+}
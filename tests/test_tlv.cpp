@@ -0,0 +1,197 @@
+/**
+ * TLV records (EEPROM_VC_TLV.h): the builder, reading fields back, torn writes and switching between the TLV and
+ * versionData formats. Built once per storage configuration, see CMakeLists.txt.
+ */
+
+#define EEPROM_VC_TLV_USER_FIELDS(FIELD) \
+    FIELD(BOARD_REVISION, 128, 4)
+
+#include <EEPROM_VC_TLV.h>
+#include "check.h"
+
+#include <string.h>
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    tlvRecordBuilder serialRecord(const char *serialNumber) {
+        tlvRecordBuilder record;
+        record.addString<TLV_PROJECT_NAME>(PROJECT_NAME);
+        record.addString(TLV_SERIAL_NUMBER, serialNumber);
+        return record;
+    }
+
+    bool storedSerialIs(const char *serialNumber) {
+        char buffer[20];
+        return readTLVString(TLV_SERIAL_NUMBER, buffer, sizeof(buffer)) && strcmp(buffer, serialNumber) == 0;
+    }
+
+    void testSchema() {
+        CHECK(tlvMaxLength(TLV_PROJECT_NAME) == 20);
+        CHECK(tlvMaxLength(TLV_BOARD_REVISION) == 4);
+        CHECK(tlvField<TLV_BOARD_REVISION>::maxLength == 4);
+        CHECK(tlvMaxLength(9) == 0 && tlvMaxLength(200) == 0);
+    }
+
+    void testBuilderRejects() {
+        tlvRecordBuilder record;
+        const uint8_t value[4] = {1, 2, 3, 4};
+        CHECK(record.addByte(TLV_VENDOR, 'M'));
+        CHECK(!record.addByte(TLV_VENDOR, 'N'));                     // duplicate tag
+        CHECK(!record.add(9, value, 1) && !record.add(9, value, 0)); // unknown tag, with or without a value
+        CHECK(!record.add(TLV_BOARD_REVISION, value, 5));           // longer than the schema allows
+        CHECK(!record.addString(TLV_SOFTWARE_VERSION, "1.10.200"));
+        CHECK(record.length() == TLV_FIELD_HEADER_BYTES + 1);
+
+        // fill the buffer, then every further field is refused and the buffer is unchanged
+        CHECK(record.addString(TLV_PROJECT_NAME, "12345678901234567890"));
+        CHECK(record.addString(TLV_SOFTWARE_DATE, "September 23, 2024"));
+        const uint8_t fillerTags[] = {TLV_SERIAL_NUMBER, TLV_BUILD_ID, TLV_SOFTWARE_VERSION};
+        for (uint8_t tag : fillerTags) {
+            const uint8_t room = MAX_PAYLOAD_BYTES - record.length();
+            if (room < TLV_FIELD_HEADER_BYTES) break;
+            uint8_t filler[20];
+            memset(filler, 'x', sizeof(filler));
+            const uint8_t length = (room - TLV_FIELD_HEADER_BYTES < tlvMaxLength(tag)) ? room - TLV_FIELD_HEADER_BYTES : tlvMaxLength(tag);
+            CHECK(record.add(tag, filler, length));
+        }
+        CHECK(record.length() == MAX_PAYLOAD_BYTES || MAX_PAYLOAD_BYTES - record.length() < TLV_FIELD_HEADER_BYTES);
+        CHECK(!record.add(TLV_BOARD_REVISION, value, 0) && !record.addByte(TLV_PROJECT_VERSION, 1));
+        CHECK(!record.has(TLV_BOARD_REVISION) && !record.has(TLV_PROJECT_VERSION));
+    }
+
+    void testConfiguredRoundTrip() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        CHECK(!validateTLVRecord());
+        const tlvRecordBuilder record = configuredTLVRecord();
+        CHECK(writeTLVRecord(record).bytesWritten > 0 && validateTLVRecord());
+        CHECK(writeTLVRecord(record, true).bytesWritten == 0);
+
+        char buffer[21];
+        uint8_t projectVersion = 0;
+        CHECK(readTLVString(TLV_PROJECT_NAME, buffer, sizeof(buffer)) && strcmp(buffer, PROJECT_NAME) == 0);
+        CHECK(readTLVString(TLV_VENDOR, buffer, sizeof(buffer)) && strcmp(buffer, VENDOR) == 0);
+        CHECK(readTLVByte(TLV_PROJECT_VERSION, projectVersion) && projectVersion == PROJECT_VERSION);
+        CHECK(readTLVString(TLV_SOFTWARE_VERSION, buffer, sizeof(buffer)) && strcmp(buffer, SOFTWARE_VERSION) == 0);
+        CHECK(readTLVString(TLV_SOFTWARE_DATE, buffer, sizeof(buffer)) && strcmp(buffer, SOFTWARE_DATE) == 0);
+        uint32_t fingerprint = 0;
+        CHECK(record.has(TLV_FINGERPRINT) && readTLVFingerprint(fingerprint) && fingerprint == CONFIGURED_FINGERPRINT);
+        CHECK(record.length() == CONFIGURED_TLV_PAYLOAD_BYTES && record.has(TLV_BUILD_ID) == (sizeof(SOFTWARE_BUILD_ID) > 1));
+        // in the default single slot layout, a build id stamped from git ("<12 hex digits>-dirty") fits as well
+        if (SLOT_COUNT == 1) {
+            CHECK(CONFIGURED_TLV_PAYLOAD_BYTES + TLV_FIELD_HEADER_BYTES + sizeof("3f2a9c1d8e7b-dirty") - 1 <= MAX_PAYLOAD_BYTES);
+        }
+        CHECK(!readTLVByte(TLV_SOFTWARE_VERSION, projectVersion));  // not one byte long
+        CHECK(!readTLVString(TLV_SERIAL_NUMBER, buffer, sizeof(buffer)));
+    }
+
+    void testUserFieldAndTruncation() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        tlvRecordBuilder record = serialRecord("SN0042");
+        const uint8_t revision[4] = {'r', 'e', 'v', 'C'};
+        CHECK(record.add(TLV_BOARD_REVISION, revision, sizeof(revision)));
+        writeTLVRecord(record);
+
+        uint16_t address = 0;
+        uint8_t length = 0;
+        uint8_t stored[4] = {};
+        CHECK(findTLVField(TLV_BOARD_REVISION, address, length) && length == sizeof(revision));
+        readBlock(address, stored, sizeof(stored));
+        CHECK(memcmp(stored, revision, sizeof(revision)) == 0);
+
+        char small[4] = {'?', '?', '?', '?'};
+        CHECK(readTLVString(TLV_SERIAL_NUMBER, small, sizeof(small)) && strcmp(small, "SN0") == 0);
+        CHECK(!readTLVString(TLV_SERIAL_NUMBER, small, 0) && small[0] == 'S');
+    }
+
+    // every cut while one TLV record replaces another leaves the old record, the new one, or (one slot) nothing
+    void testTornWrites() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        writeTLVRecord(serialRecord("OLD-0001"));
+        SimulatedEEPROM prepared = device;
+        device.resetStats();
+        const uint32_t fullWrite = writeTLVRecord(serialRecord("NEW-0002"), true).bytesWritten;
+        CHECK(fullWrite > 0 && storedSerialIs("NEW-0002"));
+
+        for (uint32_t cut = 1; cut < fullWrite; cut++) {
+            SimulatedEEPROM torn = prepared;
+            SimulatedEEPROM::attach(torn);
+            torn.resetStats();
+            torn.setWriteLimit(cut);
+            writeTLVRecord(serialRecord("NEW-0002"), true);
+            if (SLOT_COUNT > 1) {
+                CHECK(storedSerialIs("OLD-0001") || storedSerialIs("NEW-0002"));
+            } else {
+                CHECK(!validateTLVRecord() || storedSerialIs("OLD-0001") || storedSerialIs("NEW-0002"));
+            }
+        }
+        SimulatedEEPROM::attach(device);
+    }
+
+    // the slots hold one format at a time: switching needs `overwrite` and the old format is gone afterwards, even
+    // if the switch is cut short
+    void testFormatSwitch() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+        versionData stored;
+        writeDataToEEPROM();
+        CHECK(writeTLVRecord(serialRecord("SN0042")).bytesWritten == 0 && !validateTLVRecord());
+
+        SimulatedEEPROM versionDataStored = device;
+        device.resetStats();
+        const uint32_t toTLV = writeTLVRecord(serialRecord("SN0042"), true).bytesWritten;
+        CHECK(toTLV > 0 && storedSerialIs("SN0042"));
+        CHECK(!getVersionData(stored) && !dataIsWritten());
+        for (uint32_t cut = 1; cut < toTLV; cut++) {
+            SimulatedEEPROM torn = versionDataStored;
+            SimulatedEEPROM::attach(torn);
+            torn.resetStats();
+            torn.setWriteLimit(cut);
+            writeTLVRecord(serialRecord("SN0042"), true);
+            const bool tlv = validateTLVRecord();
+            CHECK(!(tlv && getVersionData(stored)));
+            CHECK(!tlv || storedSerialIs("SN0042"));
+            if (SLOT_COUNT > 1) {
+                CHECK(tlv || getVersionData(stored));
+            }
+        }
+
+        SimulatedEEPROM::attach(device);
+        SimulatedEEPROM tlvStored = device;
+        CHECK(writeDataToEEPROM().bytesWritten == 0 && !getVersionData(stored));
+        device.resetStats();
+        const uint32_t toVersionData = writeDataToEEPROM(true).bytesWritten;
+        CHECK(toVersionData > 0 && getVersionData(stored) && !validateTLVRecord());
+        for (uint32_t cut = 1; cut < toVersionData; cut++) {
+            SimulatedEEPROM torn = tlvStored;
+            SimulatedEEPROM::attach(torn);
+            torn.resetStats();
+            torn.setWriteLimit(cut);
+            writeDataToEEPROM(true);
+            const bool tlv = validateTLVRecord();
+            CHECK(!(tlv && getVersionData(stored)));
+            if (SLOT_COUNT > 1) {
+                CHECK(tlv || getVersionData(stored));
+            }
+            // finishing the switch after the cut leaves only the versionData record
+            torn.setWriteLimit(UINT32_MAX);
+            writeDataToEEPROM(true);
+            CHECK(getVersionData(stored) && !validateTLVRecord());
+        }
+        SimulatedEEPROM::attach(device);
+    }
+}
+
+int main() {
+    testSchema();
+    testBuilderRejects();
+    testConfiguredRoundTrip();
+    testUserFieldAndTruncation();
+    testTornWrites();
+    testFormatSwitch();
+    return checkFailures();
+}
@@ -0,0 +1,55 @@
+/**
+ * The library included from two files of one program (this one and test_two_files_other.cpp). Built once header-only
+ * and once against the compiled library (EEPROM_VC_COMPILED), see CMakeLists.txt. The program has to link, and both
+ * files have to share one copy of each function and flash table.
+ */
+
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_Async.h>
+#include <EEPROM_VC_History.h>
+#include <EEPROM_VC_Migration.h>
+#include <EEPROM_VC_Packed.h>
+#include <EEPROM_VC_TLV.h>
+#include "check.h"
+#include "test_two_files.h"
+
+using namespace EEPROMVersionControl;
+
+namespace {
+
+    void testSharedDefinitions() {
+        const otherFile::addresses other = otherFile::libraryAddresses();
+        CHECK(other.writeConfigured == static_cast<WriteResult (*)(bool)>(writeDataToEEPROM));
+        CHECK(other.getVersionData == &getVersionData);
+        CHECK(other.printVersionData == &printVersionData);
+        CHECK(other.printStrings == PrintStrings::PRINT_DATA_DNE);
+        CHECK(other.crcTable == CRC16NibbleTable::entries);
+        CHECK(other.configuredRecord == ConfiguredRecord::bytes);
+        CHECK(other.monthNames == &PackedMonthNames::names[0][0]);
+        CHECK(other.migrationDecoders == MigrationDecoders::decoders);
+        CHECK(other.serial == &Serial);
+        CHECK(other.writeTLV == &writeTLVRecord);
+        CHECK(other.writeWithHistory == static_cast<WriteResult (*)(bool *)>(writeDataToEEPROMWithHistory));
+    }
+
+    void testBothFilesSeeOneEEPROM() {
+        SimulatedEEPROM device;
+        SimulatedEEPROM::attach(device);
+
+        // written in the other file, read and printed here and there
+        CHECK(otherFile::writeConfigured().bytesWritten > 0);
+        versionData stored;
+        CHECK(getVersionData(stored) && getLibraryVersion(stored) == LIBRARY_VERSION);
+        otherFile::BufferPrint here;
+        printVersionData(stored, here);
+        CHECK(here.text.find("Software Version: ") != std::string::npos);
+        CHECK(otherFile::printStored() == here.text);
+        CHECK(writeDataToEEPROM(true).bytesWritten == 0);
+    }
+}
+
+int main() {
+    testSharedDefinitions();
+    testBothFilesSeeOneEEPROM();
+    return checkFailures();
+}
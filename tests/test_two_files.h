@@ -0,0 +1,48 @@
+/**
+ * What test_two_files_other.cpp offers test_two_files.cpp.
+ */
+
+#ifndef TEST_TWO_FILES_H
+#define TEST_TWO_FILES_H
+
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_History.h>
+#include <EEPROM_VC_Migration.h>
+#include <EEPROM_VC_TLV.h>
+
+#include <string>
+
+namespace otherFile {
+
+    using namespace EEPROMVersionControl;
+
+    struct BufferPrint : public Print {
+        std::string text;
+        size_t write(uint8_t c) override {
+            text += static_cast<char>(c);
+            return 1;
+        }
+        using Print::write;
+    };
+
+    // where the library's functions and flash tables are, as seen from the other file
+    struct addresses {
+        WriteResult (*writeConfigured)(bool);
+        bool (*getVersionData)(versionData &);
+        void (*printVersionData)(const versionData &, Print &);
+        const char *printStrings;
+        const uint16_t *crcTable;
+        const uint8_t *configuredRecord;
+        const char *monthNames;
+        const migrationDecoder *migrationDecoders;
+        const Print *serial;
+        WriteResult (*writeTLV)(const tlvRecordBuilder &, bool);
+        WriteResult (*writeWithHistory)(bool *);
+    };
+
+    addresses libraryAddresses();
+    WriteResult writeConfigured();
+    std::string printStored();
+}
+
+#endif // TEST_TWO_FILES_H
@@ -0,0 +1,32 @@
+/**
+ * Second file of test_two_files, with its own copy of the library's inline code (header-only build) or calls
+ * into the compiled library (EEPROM_VC_COMPILED).
+ */
+
+#include <EEPROM_Version_Control.h>
+#include <EEPROM_VC_Async.h>
+#include <EEPROM_VC_History.h>
+#include <EEPROM_VC_Migration.h>
+#include <EEPROM_VC_Packed.h>
+#include <EEPROM_VC_TLV.h>
+#include "test_two_files.h"
+
+namespace otherFile {
+
+    addresses libraryAddresses() {
+        return addresses{writeDataToEEPROM, getVersionData, printVersionData, PrintStrings::PRINT_DATA_DNE,
+                         CRC16NibbleTable::entries, ConfiguredRecord::bytes, &PackedMonthNames::names[0][0],
+                         MigrationDecoders::decoders, &Serial, writeTLVRecord,
+                         writeDataToEEPROMWithHistory};
+    }
+
+    WriteResult writeConfigured() {
+        return writeDataToEEPROM(true);
+    }
+
+    std::string printStored() {
+        BufferPrint out;
+        printVersionDataFromEEPROM(out);
+        return out.text;
+    }
+}
@@ -0,0 +1,108 @@
+# Runs extras/version_stamp/version_stamp.cmake against a scratch git repository and checks the values it stamps,
+# and that running it again on the same commit leaves the generated conf untouched. Run by ctest:
+#
+#     cmake -D SOURCE_DIR=<library> -D WORK_DIR=<scratch directory> -P test_version_stamp.cmake
+
+find_package(Git QUIET)
+if(NOT GIT_FOUND)
+    message("git not found, skipping")
+    return()
+endif()
+
+set(script ${SOURCE_DIR}/extras/version_stamp/version_stamp.cmake)
+set(repo ${WORK_DIR}/repo)
+set(out ${WORK_DIR}/CL_Version_Data.conf)
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${repo})
+file(COPY ${SOURCE_DIR}/src/CL_Version_Data.conf DESTINATION ${repo})
+
+set(ENV{GIT_AUTHOR_DATE} "2025-03-07T12:00:00Z")
+set(ENV{GIT_COMMITTER_DATE} "2025-03-07T12:00:00Z")
+unset(ENV{SOURCE_DATE_EPOCH})
+
+set(failures 0)
+
+function(run_git)
+    execute_process(COMMAND ${GIT_EXECUTABLE} -c user.name=test -c user.email=test@example.com ${ARGN}
+                    WORKING_DIRECTORY ${repo} RESULT_VARIABLE failed OUTPUT_QUIET ERROR_QUIET)
+    if(failed)
+        message(FATAL_ERROR "git ${ARGN} failed")
+    endif()
+endfunction()
+
+# stamp([FAILS]): runs the script, which has to succeed (or, with FAILS, to fail)
+function(stamp)
+    execute_process(COMMAND ${CMAKE_COMMAND} -D CONF_IN=${repo}/CL_Version_Data.conf -D CONF_OUT=${out}
+                            -D GIT_DIR=${repo} -P ${script}
+                    RESULT_VARIABLE failed OUTPUT_QUIET ERROR_QUIET)
+    if(failed AND NOT ARGV0 STREQUAL "FAILS")
+        message(FATAL_ERROR "version_stamp.cmake failed")
+    elseif(NOT failed AND ARGV0 STREQUAL "FAILS")
+        message(SEND_ERROR "version_stamp.cmake accepted a version longer than SOFTWARE_VERSION")
+    endif()
+endfunction()
+
+# expect(<constant> <value>): the generated conf has `constexpr char <constant>[] = "<value>"`
+function(expect constant value)
+    file(READ ${out} conf)
+    if(NOT conf MATCHES "constexpr char ${constant}\\[\\] *= *\"([^\"]*)\"")
+        message(SEND_ERROR "${constant} not found")
+    elseif(NOT CMAKE_MATCH_1 MATCHES "^${value}$")
+        message(SEND_ERROR "${constant} is \"${CMAKE_MATCH_1}\", expected \"${value}\"")
+    endif()
+endfunction()
+
+run_git(init -q)
+run_git(add CL_Version_Data.conf)
+run_git(commit -q -m first)
+
+# no tag: the abbreviated hash, and the commit date
+stamp()
+expect(SOFTWARE_VERSION "[0-9a-f]+")
+expect(SOFTWARE_DATE "March 7, 2025")
+expect(SOFTWARE_BUILD_ID "[0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f]")
+expect(PROJECT_NAME "Sand Garden")
+
+# a version tag, then commits since the tag as the last component
+run_git(tag v1.2.0)
+stamp()
+expect(SOFTWARE_VERSION "1\\.2\\.0\\.0")
+run_git(commit -q --allow-empty -m second)
+run_git(commit -q --allow-empty -m third)
+stamp()
+expect(SOFTWARE_VERSION "1\\.2\\.0\\.2")
+
+# the same commit again doesn't touch the output, even much later
+file(TIMESTAMP ${out} before "%s")
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.1)
+stamp()
+file(TIMESTAMP ${out} after "%s")
+if(NOT before STREQUAL after)
+    message(SEND_ERROR "the conf was rewritten for the same commit")
+endif()
+
+# uncommitted changes are flagged in the build id only
+file(APPEND ${repo}/CL_Version_Data.conf "\n")
+stamp()
+expect(SOFTWARE_VERSION "1\\.2\\.0\\.2")
+expect(SOFTWARE_BUILD_ID "[0-9a-f]+-dirty")
+
+# SOURCE_DATE_EPOCH overrides the commit date
+set(ENV{SOURCE_DATE_EPOCH} 1736942400)
+stamp()
+expect(SOFTWARE_DATE "January 15, 2025")
+
+# a tag with no room for the commit count is used alone, never cut in the middle of a component
+run_git(commit -q --allow-empty -m fourth)
+run_git(tag v1.10.20)
+stamp()
+expect(SOFTWARE_VERSION "1\\.10\\.20")
+run_git(commit -q --allow-empty -m fifth)
+run_git(tag v1.2.30)
+run_git(commit -q --allow-empty -m sixth)
+stamp()
+expect(SOFTWARE_VERSION "1\\.2\\.30")
+
+# a tag that doesn't fit at all stops the build
+run_git(tag v10.20.300)
+stamp(FAILS)